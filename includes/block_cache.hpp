@@ -0,0 +1,96 @@
+#pragma once
+
+#include "memory.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// One pre-decoded instruction. imm holds the bytes after the opcode (little endian), so handlers never re-fetch them.
+struct MicroOp {
+    uint16_t pc;
+    uint16_t imm;
+    uint8_t opcode;
+    uint8_t length;
+    uint8_t cycles; // Base T-states (not-taken for conditional branches)
+};
+
+// memset/memcpy-style ROM loops the CPU can run as one bulk operation. Each ends in JR/JP NZ back to its start.
+enum class BulkLoop : uint8_t {
+    None,
+    Fill8,  // LD [HL+/-], A; DEC r
+    Copy8,  // LD A, [HL+/-]; LD [DE], A; INC DE; DEC B/C
+    Fill16, // LD A, n8 / XOR A; LD [HL+/-], A; DEC BC; LD A, B; OR C
+    Copy16, // LD A, [HL+/-]; LD [DE], A; INC DE; DEC BC; LD A, B; OR C
+};
+
+// Straight-line run of instructions ending at the first branch, HALT/STOP or region boundary.
+struct Block {
+    uint16_t bank;
+    uint16_t start;
+    uint16_t end; // One past the last byte
+    std::vector<MicroOp> ops;
+    // T-states per iteration if the block ends in a conditional branch back to its start, 0 otherwise.
+    uint16_t loop_cycles;
+    // A load into A followed by flag tests on A: every iteration behaves the same while the value read does.
+    bool poll_loop;
+    BulkLoop bulk_loop;
+};
+
+// Caches decoded blocks for code running from ROM, WRAM and HRAM, keyed by (bank, PC).
+// Blocks from RAM are dropped as soon as a byte of the 64-byte pages they cover is written.
+class BlockCache {
+  public:
+    BlockCache(Memory &memory);
+
+    // Returns the block starting at pc, decoding it on a miss, or nullptr if pc lies outside a cacheable region.
+    const Block *lookup(uint16_t pc);
+
+    // Decodes the instruction at pc through the regular memory read path.
+    static MicroOp decode(const Memory &memory, uint16_t pc);
+    // Reads the length - 1 immediate bytes following pc.
+    static uint16_t read_immediate(const Memory &memory, uint16_t pc, uint8_t length);
+    static uint8_t length(uint8_t opcode);
+
+    // Bumped whenever blocks are dropped, so holders of a Block pointer know to look it up again.
+    uint32_t generation() const { return this->generation_; }
+    // Blocks stay cached under their bank, but code following on from the current one may have been switched out.
+    void notify_bank_switch() { this->generation_ += 1; }
+
+    void notify_write(uint16_t address) {
+        const size_t page = address >> k_page_shift;
+        if (this->code_pages_[page]) this->invalidate_page(page);
+    }
+    void clear();
+
+    // One flag per 64-byte page of the address space, set while a cached block covers the page.
+    const bool *code_page_map() const { return this->code_pages_.data(); }
+
+    uint64_t get_lookups() const { return this->lookups_; }
+    uint64_t get_hits() const { return this->hits_; }
+    uint64_t get_executed_ops() const { return this->executed_ops_; }
+    size_t get_block_count() const { return this->blocks_.size(); }
+    void count_executed_op() { this->executed_ops_ += 1; }
+
+  private:
+    static constexpr size_t k_page_shift = 6;
+    static constexpr size_t k_page_count = 0x10000 >> k_page_shift;
+    static constexpr size_t k_max_block_ops = 64;
+
+    void invalidate_page(size_t page);
+    uint16_t bank(uint16_t pc) const;
+
+    Memory &memory_;
+
+    std::unordered_map<uint32_t, Block> blocks_;
+    std::array<Block *, 0x10000> by_pc_{}; // Most recent block per start address, checked against the bank
+    std::array<bool, k_page_count> code_pages_{};
+    std::array<std::vector<uint32_t>, k_page_count> page_blocks_{};
+    uint32_t generation_ = 0;
+
+    uint64_t lookups_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t executed_ops_ = 0;
+};
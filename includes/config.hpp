@@ -2,6 +2,15 @@
 
 #include <cstdint>
 
+// Force inlining of tiny hot-path accessors (register pairs, flags) regardless of optimisation heuristics.
+#if defined(__GNUC__) || defined(__clang__)
+#define GBEMU_ALWAYS_INLINE [[gnu::always_inline]] inline
+#elif defined(_MSC_VER)
+#define GBEMU_ALWAYS_INLINE __forceinline
+#else
+#define GBEMU_ALWAYS_INLINE inline
+#endif
+
 namespace config {
 inline constexpr uint16_t k_pc_entrypoint = 0x0100;
 inline constexpr uint32_t k_memory_size = 0x10000;
@@ -13,9 +22,27 @@ inline constexpr uint16_t k_screen_scale = 4;
 
 inline constexpr char k_window_title[] = "GBEMU";
 
+inline constexpr uint32_t k_cpu_clock_hz = 4194304;
+inline constexpr uint32_t k_tstates_per_frame = 70224;
+
 #if defined(GBEMU_DEBUG)
 inline constexpr bool k_debug_mode = true;
 #else
 inline constexpr bool k_debug_mode = false;
 #endif
+
+// Lazy flags: ALU/IDU record their last operation and Registers materialises F when it is read.
+// Debug builds keep computing the eager flags as well and check both agree after every operation.
+#if defined(GBEMU_EAGER_FLAGS)
+inline constexpr bool k_lazy_flags = false;
+#else
+inline constexpr bool k_lazy_flags = true;
+#endif
+inline constexpr bool k_eager_flags = !k_lazy_flags || k_debug_mode;
+
+#if defined(GBEMU_DEBUG) || defined(GBEMU_TABLE_DISPATCH)
+inline constexpr bool k_table_dispatch = true;
+#else
+inline constexpr bool k_table_dispatch = false;
+#endif
 } // namespace config
@@ -2,26 +2,63 @@
 
 #include "alu.hpp"
 #include "bmi.hpp"
+#include "block_cache.hpp"
 #include "idu.hpp"
+#include "jit.hpp"
 #include "memory.hpp"
 #include "ppu.hpp"
 #include "registers.hpp"
+#include "scheduler.hpp"
 #include "stack.hpp"
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <vector>
 
+class Timer;
+
 class CPU {
   public:
-    CPU(Registers &registers, Memory &memory, Stack &stack, IDU &idu, ALU &alu, BMI &bmi, PPU &ppu);
+    // Registers live in their own component; this is the execution state around them.
+    struct State {
+        bool stopped;
+        bool halted;
+        uint8_t ime_enable_delay;
+        bool halt_bug_active;
+    };
+
+    CPU(Registers &registers, Memory &memory, Stack &stack, IDU &idu, ALU &alu, BMI &bmi, PPU &ppu, BlockCache &block_cache,
+        Scheduler &scheduler);
 
     uint32_t step();
 
+    void save_state(State &state) const;
+    // Also lets go of the current block, which the restored PC need not follow on from.
+    void load_state(const State &state);
+
+    // Executes instructions back to back, without ticking anything else, until the master clock would reach
+    // target_cycle or the next instruction touches IO, changes the interrupt state, or could observe the next scheduled
+    // event. Returns the T-states the caller still has to advance the master clock by (always at least one
+    // instruction's worth).
+    uint32_t run_until(uint64_t target_cycle);
+
     void exec(uint8_t opcode);
     void exec_cb(uint8_t cb);
 
-    void service_interrupts();
+    // Returns the T-states the dispatch took, which the caller advances the master clock by.
+    uint32_t service_interrupts();
+
+    // Timer is constructed after the CPU; the JIT needs it for its cycle budget and to catch up before IO accesses.
+    void attach_timer(Timer *timer);
+    // With lockstep set, every translated block is run on a copy of WRAM/HRAM and then re-executed by the interpreter,
+    // and the two results are compared.
+    void attach_jit(Jit *jit, bool lockstep);
+
+    uint64_t get_idle_skips() const { return this->idle_skips_; }
+    uint64_t get_idle_skipped_cycles() const { return this->idle_skipped_cycles_; }
+    uint64_t get_bulk_loops() const { return this->bulk_loops_; }
+    uint64_t get_bulk_loop_cycles() const { return this->bulk_loop_cycles_; }
 
     bool stopped = false;
     bool halted = false;
@@ -34,8 +71,10 @@ class CPU {
     ALU &alu_;
     BMI &bmi_;
     PPU &ppu_;
+    BlockCache &block_cache_;
+    Scheduler &scheduler_;
 
-    uint64_t tstates = 0;
+    uint32_t tstates = 0; // Executed in the current batch; the master clock is the scheduler's
     uint8_t ime_enable_delay = 0;
     bool halt_bug_active = false;
 
@@ -51,206 +90,135 @@ class CPU {
 
     void init();
 
+    // Executes one instruction through the interpreter.
+    uint32_t interpret();
+
+    // T-states until the next PPU mode/line change or TIMA overflow (capped at a frame). Interrupts cannot become
+    // pending, and nothing a loop polls can change, before then.
+    uint32_t event_horizon();
+
+    // Looks up the block at PC and, if it is a recognised polling or bulk copy/fill loop, runs it in one go.
+    // Returns the T-states covered, or 0 if the interpreter should carry on as usual.
+    uint32_t run_loop_shortcut();
+    // Runs one iteration of a polling loop and fast-forwards over the following ones up to the horizon.
+    uint32_t skip_idle_loop(const Block &block);
+    // Runs as many iterations of a memset/memcpy loop as fit in the horizon directly against Memory.
+    uint32_t run_bulk_loop(const Block &block);
+    uint8_t &counter_register(uint8_t dec_opcode);
+
+    uint64_t idle_skips_ = 0;
+    uint64_t idle_skipped_cycles_ = 0;
+    uint64_t bulk_loops_ = 0;
+    uint64_t bulk_loop_cycles_ = 0;
+
+    // Runs the translated block at PC if there is one and it fits in the cycle budget. Returns the T-states
+    // still to be ticked by the caller, or 0 if nothing ran.
+    uint32_t run_jit_block();
+    uint32_t run_jit_lockstep(const JitBlock &block);
+    void load_jit_context();
+    void store_jit_context();
+    void jit_sync(uint32_t cycles);
+    static uint8_t jit_read_hook(JitContext *context, uint16_t address, uint32_t cycles);
+    static void jit_write_hook(JitContext *context, uint16_t address, uint8_t value, uint32_t cycles);
+
+    Timer *timer_ = nullptr;
+    Jit *jit_ = nullptr;
+    bool jit_lockstep_ = false;
+    JitContext jit_context_{};
+    uint32_t jit_synced_ = 0; // T-states of the running block already ticked by the hooks
+    std::array<uint8_t, 0x2000> jit_shadow_wram_{};
+    std::array<uint8_t, 0x007F> jit_shadow_hram_{};
+
+    // Next instruction at PC, from the current cached block when PC follows on from it. peek() leaves it in place.
+    MicroOp fetch();
+    MicroOp peek();
+    // True unless PC is in the middle of the block being executed.
+    bool at_block_start() const;
+
+    // Whether op accesses IO registers or IE, or changes the interrupt/halt state, and so must not run in the middle
+    // of a run_until() batch.
+    bool needs_sync(const MicroOp &op) const;
+    // Whether any address op reads or writes (operands, [HL]-style pointers, the stack) satisfies matches.
+    template <typename AddressPredicate> bool accesses_memory(const MicroOp &op, AddressPredicate matches) const;
+    // Cycle of the next PPU or timer event that raises an interrupt which would be taken, or Scheduler::k_never.
+    uint64_t next_interrupt_event();
+
+    const Block *block_ = nullptr;
+    const MicroOp *block_cursor_ = nullptr;
+    const MicroOp *block_end_ = nullptr;
+    uint32_t block_generation_ = 0;
+
+    // Immediate operand of the executing instruction, pre-read at fetch.
+    uint16_t imm_ = 0;
+    uint8_t imm8() const { return static_cast<uint8_t>(this->imm_); }
+    uint16_t imm16() const { return this->imm_; }
+
+    template <uint8_t Index> uint8_t &r8();
+    template <uint8_t Index> uint8_t read_r8();
+    template <uint8_t Index> void write_r8(uint8_t value);
+
+    template <uint8_t Opcode> void op_inc_r();
+    template <uint8_t Opcode> void op_dec_r();
+    template <uint8_t Opcode> void op_ld_r_r();
+    template <uint8_t Opcode> void op_alu_a_r();
+    template <uint8_t Opcode> void op_pop_rr();
+    template <uint8_t Opcode> void op_push_rr();
+
     void op_unimplemented();
 
     void op_nop();
     void op_ld_bc_n16();
     void op_ld_bcm_a();
     void op_inc_bc();
-    void op_inc_b();
-    void op_dec_b();
     void op_ld_b_n8();
     void op_rlca();
     void op_ld_a16m_sp();
     void op_add_hl_bc();
     void op_ld_a_bcm();
     void op_dec_bc();
-    void op_inc_c();
-    void op_dec_c();
     void op_ld_c_n8();
     void op_rrca();
     void op_stop_n8();
     void op_ld_de_n16();
     void op_ld_dem_a();
     void op_inc_de();
-    void op_inc_d();
-    void op_dec_d();
     void op_ld_d_n8();
     void op_rla();
     void op_jr_e8();
     void op_add_hl_de();
     void op_ld_a_dem();
     void op_dec_de();
-    void op_inc_e();
-    void op_dec_e();
     void op_ld_e_n8();
     void op_rra();
     void op_jr_nz_e8();
     void op_ld_hl_a16();
     void op_ld_hlim_a();
     void op_inc_hl();
-    void op_inc_h();
-    void op_dec_h();
     void op_ld_h_n8();
     void op_daa();
     void op_jr_z_e8();
     void op_add_hl_hl();
     void op_ld_a_hlim();
     void op_dec_hl();
-    void op_inc_l();
-    void op_dec_l();
     void op_ld_l_n8();
     void op_cpl();
     void op_jr_nc_e8();
     void op_ld_sp_a16();
     void op_ld_hldm_a();
     void op_inc_sp();
-    void op_inc_hlm();
-    void op_dec_hlm();
     void op_ld_hlm_n8();
     void op_scf();
     void op_jr_c_e8();
     void op_add_hl_sp();
     void op_ld_a_hldm();
     void op_dec_sp();
-    void op_inc_a();
-    void op_dec_a();
     void op_ld_a_n8();
     void op_ccf();
-    void op_ld_b_b();
-    void op_ld_b_c();
-    void op_ld_b_d();
-    void op_ld_b_e();
-    void op_ld_b_h();
-    void op_ld_b_l();
-    void op_ld_b_hlm();
-    void op_ld_b_a();
-    void op_ld_c_b();
-    void op_ld_c_c();
-    void op_ld_c_d();
-    void op_ld_c_e();
-    void op_ld_c_h();
-    void op_ld_c_l();
-    void op_ld_c_hlm();
-    void op_ld_c_a();
-    void op_ld_d_b();
-    void op_ld_d_c();
-    void op_ld_d_d();
-    void op_ld_d_e();
-    void op_ld_d_h();
-    void op_ld_d_l();
-    void op_ld_d_hlm();
-    void op_ld_d_a();
-    void op_ld_e_b();
-    void op_ld_e_c();
-    void op_ld_e_d();
-    void op_ld_e_e();
-    void op_ld_e_h();
-    void op_ld_e_l();
-    void op_ld_e_hlm();
-    void op_ld_e_a();
-    void op_ld_h_b();
-    void op_ld_h_c();
-    void op_ld_h_d();
-    void op_ld_h_e();
-    void op_ld_h_h();
-    void op_ld_h_l();
-    void op_ld_h_hlm();
-    void op_ld_h_a();
-    void op_ld_l_b();
-    void op_ld_l_c();
-    void op_ld_l_d();
-    void op_ld_l_e();
-    void op_ld_l_h();
-    void op_ld_l_l();
-    void op_ld_l_hlm();
-    void op_ld_l_a();
-    void op_ld_hlm_b();
-    void op_ld_hlm_c();
-    void op_ld_hlm_d();
-    void op_ld_hlm_e();
-    void op_ld_hlm_h();
-    void op_ld_hlm_l();
     void op_halt();
-    void op_ld_hlm_a();
-    void op_ld_a_b();
-    void op_ld_a_c();
-    void op_ld_a_d();
-    void op_ld_a_e();
-    void op_ld_a_h();
-    void op_ld_a_l();
-    void op_ld_a_hlm();
-    void op_ld_a_a();
-    void op_add_a_b();
-    void op_add_a_c();
-    void op_add_a_d();
-    void op_add_a_e();
-    void op_add_a_h();
-    void op_add_a_l();
-    void op_add_a_hlm();
-    void op_add_a_a();
-    void op_adc_a_b();
-    void op_adc_a_c();
-    void op_adc_a_d();
-    void op_adc_a_e();
-    void op_adc_a_h();
-    void op_adc_a_l();
-    void op_adc_a_hlm();
-    void op_adc_a_a();
-    void op_sub_a_b();
-    void op_sub_a_c();
-    void op_sub_a_d();
-    void op_sub_a_e();
-    void op_sub_a_h();
-    void op_sub_a_l();
-    void op_sub_a_hlm();
-    void op_sub_a_a();
-    void op_sbc_a_b();
-    void op_sbc_a_c();
-    void op_sbc_a_d();
-    void op_sbc_a_e();
-    void op_sbc_a_h();
-    void op_sbc_a_l();
-    void op_sbc_a_hlm();
-    void op_sbc_a_a();
-    void op_and_a_b();
-    void op_and_a_c();
-    void op_and_a_d();
-    void op_and_a_e();
-    void op_and_a_h();
-    void op_and_a_l();
-    void op_and_a_hlm();
-    void op_and_a_a();
-    void op_xor_a_b();
-    void op_xor_a_c();
-    void op_xor_a_d();
-    void op_xor_a_e();
-    void op_xor_a_h();
-    void op_xor_a_l();
-    void op_xor_a_hlm();
-    void op_xor_a_a();
-    void op_or_a_b();
-    void op_or_a_c();
-    void op_or_a_d();
-    void op_or_a_e();
-    void op_or_a_h();
-    void op_or_a_l();
-    void op_or_a_hlm();
-    void op_or_a_a();
-    void op_cp_a_b();
-    void op_cp_a_c();
-    void op_cp_a_d();
-    void op_cp_a_e();
-    void op_cp_a_h();
-    void op_cp_a_l();
-    void op_cp_a_hlm();
-    void op_cp_a_a();
     void op_ret_nz();
-    void op_pop_bc();
     void op_jp_nz_a16();
     void op_jp_a16();
     void op_call_nz_a16();
-    void op_push_bc();
     void op_add_a_n8();
     void op_rst_00();
     void op_ret_z();
@@ -262,11 +230,9 @@ class CPU {
     void op_adc_a_n8();
     void op_rst_08();
     void op_ret_nc();
-    void op_pop_de();
     void op_jp_nc_a16();
     void op_undefined_d3();
     void op_call_nc_a16();
-    void op_push_de();
     void op_sub_a_n8();
     void op_rst_10();
     void op_ret_c();
@@ -278,11 +244,9 @@ class CPU {
     void op_sbc_a_n8();
     void op_rst_18();
     void op_ldh_a8m_a();
-    void op_pop_hl();
     void op_ldh_cm_a();
     void op_unused_e3();
     void op_unused_e4();
-    void op_push_hl();
     void op_and_a_n8();
     void op_rst_20();
     void op_add_sp_e8();
@@ -294,11 +258,9 @@ class CPU {
     void op_xor_a_n8();
     void op_rst_28();
     void op_ldh_a_a8m();
-    void op_pop_af();
     void op_ldh_a_cm();
     void op_di();
     void op_unused_f4();
-    void op_push_af();
     void op_or_a_n8();
     void op_rst_30();
     void op_ld_hl_sp_e8();
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Throttles emulation to the real DMG clock (a 70224 T-state frame every 1/59.7275 s) instead of the display's
+// refresh rate. Deadlines are derived from the emulated cycle count, so uneven frame slices do not drift. Waits
+// sleep until shortly before the deadline and spin for the rest, since sleeps overshoot by up to a millisecond or so.
+class FramePacer {
+  public:
+    FramePacer();
+
+    // Blocks until real time has caught up with the emulated cycle. Returns immediately in turbo mode.
+    void pace(uint64_t cycle);
+
+    // Turbo runs unthrottled. Leaving it restarts pacing from the current point rather than waiting for real time
+    // to catch up.
+    void set_turbo(bool turbo);
+    void toggle_turbo() { this->set_turbo(!this->turbo_); }
+    bool is_turbo() const { return this->turbo_; }
+
+    // Emulation speed as a percentage of real DMG speed, measured over about a second. False until a new
+    // measurement is available.
+    bool consume_speed_report(double &percent);
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::chrono::microseconds k_spin_window{1500};
+    // Further behind than this (a stall, a window drag) and the pacer resynchronises instead of running fast to catch up.
+    static constexpr std::chrono::milliseconds k_max_lag{100};
+    static constexpr std::chrono::seconds k_report_interval{1};
+
+    void wait_until(uint64_t cycle);
+    void resync(Clock::time_point now, uint64_t cycle);
+
+    bool turbo_ = false;
+    bool synced_ = false;
+    Clock::time_point origin_time_;
+    uint64_t origin_cycle_ = 0;
+
+    Clock::time_point report_time_;
+    uint64_t report_cycle_ = 0;
+    bool report_started_ = false;
+    bool report_ready_ = false;
+    double speed_percent_ = 0.0;
+};
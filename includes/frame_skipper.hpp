@@ -0,0 +1,45 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Decides which frames get drawn. Skipped frames are still emulated exactly (PPU timing, STAT/LY and interrupts do
+// not depend on rendering); only the scanline renderers and the present are left out. A fixed setting draws one frame
+// in every skip + 1. The automatic setting measures how long drawn and skipped frames take to emulate and picks the
+// smallest ratio that leaves some headroom within a real frame period; in turbo it instead draws about one frame per
+// real frame period, since nothing faster could be shown anyway.
+class FrameSkipper {
+  public:
+    static constexpr uint32_t k_auto = UINT32_MAX;
+    static constexpr uint32_t k_max_skip = 4;
+
+    // 0 draws every frame (the default), k_auto adjusts the ratio at run time.
+    void set_mode(uint32_t skip);
+
+    // Called before each frame is emulated. False if it should be skipped.
+    bool begin_frame(bool turbo);
+    // Called once the frame has been emulated, before any pacing wait.
+    void end_frame();
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr uint32_t k_window_frames = 30;
+    static constexpr double k_target_load = 0.8; // Share of a real frame period the emulation may use on average
+
+    void adjust();
+
+    bool auto_ = false;
+    uint32_t skip_ = 0;
+    uint32_t skipped_in_row_ = 0;
+
+    bool drawing_ = true;
+    Clock::time_point frame_start_;
+    Clock::time_point last_drawn_;
+
+    // Measurements over the current window, in seconds.
+    double drawn_time_ = 0.0;
+    double skipped_time_ = 0.0;
+    uint32_t drawn_frames_ = 0;
+    uint32_t skipped_frames_ = 0;
+};
@@ -1,20 +1,34 @@
 #pragma once
 
 #include "alu.hpp"
+#include "block_cache.hpp"
 #include "bmi.hpp"
 #include "config.hpp"
 #include "cpu.hpp"
+#include "frame_pacer.hpp"
+#include "frame_skipper.hpp"
 #include "idu.hpp"
+#include "jit.hpp"
 #include "joypad.hpp"
+#include "mbc.hpp"
 #include "memory.hpp"
 #include "ppu.hpp"
 #include "registers.hpp"
+#include "rom_image.hpp"
+#include "scheduler.hpp"
 #include "screen.hpp"
+#include "spsc_queue.hpp"
 #include "stack.hpp"
 #include "timer.hpp"
 
+#include <SDL2/SDL.h>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -33,6 +47,7 @@ struct CartridgeInfo {
     int num_rom_banks;
     int ram_size_kb;
 
+    uint8_t cartridge_type_code;
     std::string cartridge_type;
     std::string destination;
 
@@ -42,16 +57,83 @@ struct CartridgeInfo {
     uint16_t global_checksum;
 };
 
+// Snapshot of the whole emulated machine. Kept around and reused, so saving does not allocate once warm.
+struct SaveState {
+    Memory::State memory;
+    Mbc::State mbc;
+    Registers registers;
+    Scheduler scheduler;
+    CPU::State cpu;
+    PPU::State ppu;
+    Timer::State timer;
+    Joypad::State joypad;
+};
+
 class GB {
   public:
     GB();
 
     CartridgeInfo read_cartridge_header();
-    void boot(std::vector<uint8_t> &rom_buf);
+    void boot(const RomImage &rom);
+    // Emulates on a separate thread while this one handles SDL events and presents finished frames, so a slow
+    // present never holds up the CPU core. Returns once the window is closed.
     void run();
 
+    // Runs the ROM headless for the given number of frames and prints the emulated clock speed.
+    void benchmark(const RomImage &rom, uint32_t frames);
+
+    // Translates hot ROM blocks to native code. Throws if the JIT is not available in this build.
+    void enable_jit(bool lockstep);
+
+    // Where battery-backed cartridge RAM is kept between sessions: read at boot, written when the window is closed.
+    void set_battery_file(const std::string &path);
+
+    // Shows the cartridge logo until the first frame is ready. On by default.
+    void set_splash(bool splash);
+
+    // Starts without frame pacing. Tab toggles it at runtime.
+    void set_turbo(bool turbo);
+
+    // Draws one frame in every skip + 1, or FrameSkipper::k_auto to adjust the ratio to the host's speed.
+    void set_frame_skip(uint32_t skip);
+
+    // Run-ahead: after each frame, the state is saved, the given number of frames is emulated ahead with the current
+    // input and the last of them is shown, and then the state is restored. Hides that many frames of a game's own
+    // input lag, at the cost of emulating them on top of every frame. 0 (the default) turns it off.
+    void set_run_ahead(uint32_t frames);
+
+    void save_state(SaveState &state) const;
+    void load_state(const SaveState &state);
+
   private:
+    CartridgeInfo load(const RomImage &rom);
+    void load_battery();
+    void save_battery();
+    // Runs one CPU batch (see CPU::run_until) plus any interrupt dispatch after it, advancing the master clock by both.
+    void run_until(uint64_t target_cycle);
+    // Moves the master clock forward and has the PPU and timer catch up if anything of theirs has become due.
+    void advance(uint32_t cycles);
+    // Display thread: drains the SDL event queue, forwarding input to the emulation thread (Tab toggles turbo).
+    // False once the window is closed.
+    bool handle_events();
+    void update_window_title();
+    // Emulation thread: runs paced frames until running is cleared. Input is applied once per frame. An exception
+    // stops the emulation and is rethrown by run().
+    void emulate();
+    // Emulates until the PPU finishes a frame, which is then published to the screen unless it was skipped, or for
+    // one frame's worth of T-states while the LCD is off.
+    void run_frame();
+    void print_block_cache_stats() const;
+    void print_jit_stats() const;
+    void print_loop_stats(uint64_t t_states) const;
+    void print_run_ahead_stats() const;
+    // Emulates the frames shown in place of the one just finished (see set_run_ahead) and rewinds afterwards.
+    void run_ahead(bool draw);
+
     Memory memory;
+    Scheduler scheduler; // Owns the master clock every component's state is relative to
+    Mbc mbc;
+    BlockCache block_cache;
     Registers registers;
     Stack stack;
     Screen screen;
@@ -62,6 +144,31 @@ class GB {
     CPU cpu;
     Timer timer;
     Joypad joypad;
+    std::unique_ptr<Jit> jit;
+    FramePacer frame_pacer;
+    FrameSkipper frame_skipper;
+
+    uint32_t run_ahead_frames = 0;
+    SaveState run_ahead_state;
+    // Host time spent running ahead (save, extra frames, restore): in total, and over the current report interval.
+    std::chrono::steady_clock::duration run_ahead_time{};
+    uint64_t run_ahead_count = 0;
+    std::chrono::steady_clock::duration run_ahead_interval_time{};
+    uint32_t run_ahead_interval_count = 0;
+    SDL_Window *window = nullptr;
+    bool show_splash = true;
+    std::string battery_file;
+    std::chrono::steady_clock::time_point boot_started;
+    std::deque<SDL_Event> pending_input_events; // Display thread only: key events input_events had no room for yet
+
+    // Shared between the display and emulation threads.
+    SpscQueue<SDL_Event, 64> input_events;
+    std::atomic<bool> running{false};
+    std::atomic<bool> turbo_enabled{false};
+    std::atomic<double> speed_percent{0.0};
+    std::atomic<double> run_ahead_ms{0.0}; // Average cost per frame over the last report interval
+    std::atomic<bool> title_stale{false};
+    std::exception_ptr emulation_error;
 
     static const std::unordered_map<uint8_t, std::string> cartridge_types;
     static const std::unordered_map<uint8_t, std::string> old_licensees;
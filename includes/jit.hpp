@@ -0,0 +1,88 @@
+#pragma once
+
+#include "block_cache.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class CPU;
+
+// State shared between the CPU and translated code. Offsets are baked into the generated code.
+struct JitContext {
+    uint8_t a, f, b, c, d, e, h, l; // Guest registers, loaded on entry and stored on exit
+    uint16_t pc;                    // Exit PC
+    uint8_t stop_after_write;       // Set by the write hook: IO state changed, leave after this instruction
+    uint8_t reserved;
+
+    uint8_t *wram;              // 0xC000-0xDFFF
+    uint8_t *hram;              // 0xFF80-0xFFFE
+    const uint8_t *rom;         // 0x0000-
+    uint32_t rom_limit;         // Reads below this address come straight from rom
+    uint32_t reserved2;
+    const bool *code_pages;     // BlockCache 64-byte code page map, writes there go through Memory
+    const uint8_t *flag_table;  // LAHF (SF ZF - AF - PF - CF) -> SM83 Z - H C
+
+    // Hooks for everything outside ROM/WRAM/HRAM; nullptr in lockstep mode, where such accesses side-exit instead.
+    // cycles is the number of T-states the block has executed before the access.
+    uint8_t (*read)(JitContext *context, uint16_t address, uint32_t cycles);
+    void (*write)(JitContext *context, uint16_t address, uint8_t value, uint32_t cycles);
+    CPU *cpu;
+};
+
+using JitBlockFn = uint32_t (*)(JitContext *context);
+
+struct JitBlock {
+    uint16_t bank;
+    uint16_t executions;
+    JitBlockFn fn;       // nullptr while cold or when the block cannot be translated
+    uint32_t max_cycles; // Upper bound over all exits, checked against the event horizon before entering
+    bool tried;
+};
+
+// Optional x86-64 (System V) translator for hot ROM blocks. Guest registers live in r8-r15 while a block runs,
+// flags are rebuilt from LAHF through a lookup table, and WRAM/HRAM/ROM accesses are inlined. Anything else calls
+// back into the CPU (which first catches the PPU and timer up) or, when hooks are disabled, leaves the block.
+// Instructions it does not know end the translated prefix and the interpreter takes over from there.
+class Jit {
+  public:
+    Jit(BlockCache &block_cache, bool use_hooks);
+    ~Jit();
+
+    Jit(const Jit &) = delete;
+    Jit &operator=(const Jit &) = delete;
+
+    // True when the translator is compiled in and the host is x86-64.
+    static bool available();
+
+    // Translated block starting at pc, compiling it once it is hot. nullptr if cold, untranslatable or not in ROM.
+    const JitBlock *lookup(uint16_t pc, uint16_t bank);
+
+    const uint8_t *flag_table() const { return this->flag_table_.data(); }
+
+    uint64_t get_compiled_blocks() const { return this->compiled_blocks_; }
+    uint64_t get_native_runs() const { return this->native_runs_; }
+    void count_native_run() { this->native_runs_ += 1; }
+
+  private:
+    static constexpr uint16_t k_hot_threshold = 8;
+    static constexpr uint16_t k_rom_end = 0x7FFF;
+
+    JitBlockFn compile(const Block &block, uint32_t &max_cycles);
+    uint8_t *allocate_code(size_t size);
+
+    BlockCache &block_cache_;
+    bool use_hooks_;
+
+    std::unordered_map<uint32_t, JitBlock> blocks_;
+    std::array<JitBlock *, k_rom_end + 1> by_pc_{};
+    std::array<uint8_t, 256> flag_table_{};
+
+    std::vector<std::pair<uint8_t *, size_t>> code_chunks_;
+    size_t chunk_used_ = 0;
+
+    uint64_t compiled_blocks_ = 0;
+    uint64_t native_runs_ = 0;
+};
@@ -7,12 +7,22 @@
 
 class Joypad {
   public:
+    // The P10-P13 lines as last seen by the machine. Which keys are held is host input and stays as it is.
+    struct State {
+        uint8_t select_bits;
+        uint8_t low_nibble;
+    };
+
     explicit Joypad(Memory &memory);
 
+    void save_state(State &state) const;
+    void load_state(const State &state);
+
+    // Key and select changes update the P10-P13 lines right away and raise the joypad interrupt when a selected
+    // line goes low, so nothing has to be polled between them.
     void handle_event(const SDL_Event &event);
     void set_joyp(uint8_t value);
     uint8_t get_joyp() const;
-    void tick();
 
   private:
     struct Keys_ {
@@ -23,10 +33,11 @@ class Joypad {
     void set_key_(SDL_Scancode sc, bool pressed);
     uint8_t get_low_nibble_() const;
     uint8_t compose_joyp_() const;
+    void update_lines_();
 
     Memory &memory_;
     Keys_ keys_{};
 
     uint8_t select_bits_ = 0x30; // 0b00110000
-    uint8_t prev_low_nibble_ = 0x0F;
+    uint8_t low_nibble_ = 0x0F;
 };
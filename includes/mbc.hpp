@@ -0,0 +1,90 @@
+#pragma once
+
+#include "memory.hpp"
+#include "scheduler.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+// Memory bank controller of the cartridge. Owns the cartridge RAM and the bank registers; a bank switch repoints
+// Memory's 0x0000-0x7FFF and 0xA000-0xBFFF page table entries into the ROM image and the RAM, nothing is copied.
+class Mbc {
+  public:
+    enum class Kind { None, Mbc1, Mbc2, Mbc3, Mbc5 };
+
+    // Bank registers, cartridge RAM and the MBC3 clock, for save states.
+    struct State {
+        std::vector<uint8_t> ram;
+        bool ram_enabled;
+        uint16_t bank1;
+        uint8_t bank2;
+        bool advanced_banking;
+        uint64_t rtc_seconds;
+        uint64_t rtc_synced_cycle;
+        uint32_t rtc_halted_cycles;
+        bool rtc_halted;
+        bool rtc_carry;
+        bool rtc_latch_armed;
+        std::array<uint8_t, 5> rtc_latched;
+    };
+
+    Mbc(Memory &memory, Scheduler &scheduler);
+
+    // Sets the controller up for the cartridge type byte of the header (0x0147) and maps the power-on banks. Throws
+    // for cartridge types that are not supported.
+    void configure(uint8_t cartridge_type, size_t ram_size);
+
+    void save_state(State &state) const;
+    void load_state(const State &state);
+
+    // Writes to 0x0000-0x7FFF.
+    void write_register(uint16_t address, uint8_t value);
+    // Cartridge RAM accesses that Memory has no page mapped for: RAM that is disabled or smaller than a bank, MBC2's
+    // 4-bit RAM and the MBC3 clock registers.
+    uint8_t read_ram(uint16_t address) const;
+    void write_ram(uint16_t address, uint8_t value);
+
+    bool has_battery() const { return this->battery_; }
+    // Battery-backed RAM as stored in .sav files. With a clock, the RAM is followed by the usual 48-byte footer: the
+    // live and latched registers and the host time they were saved at, which is made up for on loading.
+    void load_battery(std::istream &in);
+    void save_battery(std::ostream &out);
+
+  private:
+    // Points Memory's page tables at the banks the registers select.
+    void remap();
+    size_t ram_offset(uint16_t address) const;
+
+    // The clock is a count of seconds that is brought up to date from the scheduler's cycle counter only when it is
+    // latched, written or saved, so a running clock costs nothing in between. It keeps emulated time, which save
+    // states and run-ahead rewind along with everything else.
+    void rtc_sync();
+    void rtc_add_seconds(uint64_t seconds);
+    std::array<uint8_t, 5> rtc_registers() const;
+    void rtc_write(uint8_t select, uint8_t value);
+
+    Memory &memory_;
+    Scheduler &scheduler_;
+
+    Kind kind_ = Kind::None;
+    bool battery_ = false;
+    bool rtc_ = false;
+    bool rumble_ = false; // MBC5 motor on bit 3 of the RAM bank register, not emulated
+    std::vector<uint8_t> ram_;
+
+    bool ram_enabled_ = false;
+    uint16_t bank1_ = 1;            // MBC1: ROM bank bits 0-4, MBC2/MBC3/MBC5: ROM bank
+    uint8_t bank2_ = 0;             // MBC1: RAM bank, or ROM bank bits 5-6, MBC3: RAM bank or clock register, MBC5: RAM bank
+    bool advanced_banking_ = false; // MBC1 mode 1: bank2 also applies to 0x0000-0x3FFF and the RAM
+
+    uint64_t rtc_seconds_ = 0;       // Days, hours, minutes and seconds as one count, below 512 days
+    uint64_t rtc_synced_cycle_ = 0;  // Cycle at which rtc_seconds_ last ticked over
+    uint32_t rtc_halted_cycles_ = 0; // Part of a second the clock had counted when it was halted
+    bool rtc_halted_ = false;
+    bool rtc_carry_ = false;       // Day counter overflow, sticky until written
+    bool rtc_latch_armed_ = false; // 0x00 was written to 0x6000-0x7FFF, a 0x01 next latches
+    std::array<uint8_t, 5> rtc_latched_{};
+};
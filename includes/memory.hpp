@@ -1,19 +1,67 @@
 #pragma once
 
+#include "config.hpp"
+
 #include <array>
 #include <cstddef>
 #include <cstdint>
 #include <vector>
 
-class Joypad;
+class BlockCache;
+class Mbc;
+class RomImage;
 
 class Memory {
   public:
-    void load_rom(const std::vector<uint8_t> &rom);
-
-    uint8_t read_byte(uint16_t address) const;
-    uint8_t read_byte_unrestricted(uint16_t address) const;
-    void write_byte(uint16_t address, uint8_t value);
+    // Everything but the cartridge, for save states. Its banks and RAM belong to Mbc.
+    struct State {
+        std::array<uint8_t, 0x2000> vram;
+        std::array<uint8_t, 0x2000> wram;
+        std::array<uint8_t, 0x00A0> oam;
+        std::array<uint8_t, 0x0080> io;
+        std::array<uint8_t, 0x007F> hram;
+        uint8_t ie;
+        bool vram_blocked;
+        bool oam_blocked;
+    };
+
+    // Side effects of an IO register, registered by the component that implements it when it is constructed. A null
+    // read returns the stored value, a null write stores the value.
+    struct IoHandler {
+        void *owner = nullptr;
+        uint8_t (*read)(void *owner, uint16_t address) = nullptr;
+        void (*write)(void *owner, uint16_t address, uint8_t value) = nullptr;
+    };
+
+    Memory();
+    // The page tables point into this object.
+    Memory(const Memory &) = delete;
+    Memory &operator=(const Memory &) = delete;
+
+    // Maps the ROM without copying it; the image has to stay alive while it is loaded.
+    void load_rom(const RomImage &rom);
+
+    // Plain memory is one lookup in a 256-entry table of host pages. Null pages (IO and HRAM, the OAM page, locked
+    // VRAM, ROM and cartridge RAM that do not fill a page, echo RAM writes, ROM writes) go through the handlers.
+    GBEMU_ALWAYS_INLINE uint8_t read_byte(uint16_t address) const {
+        const uint8_t *page = this->read_pages_[address >> 8];
+        if (page != nullptr) return page[address & 0xFF];
+        return this->read_byte_impl(address, true);
+    }
+
+    // Ignores the VRAM/OAM locks, for the PPU and OAM DMA.
+    GBEMU_ALWAYS_INLINE uint8_t read_byte_unrestricted(uint16_t address) const {
+        const uint8_t *page = this->unlocked_read_pages_[address >> 8];
+        if (page != nullptr) return page[address & 0xFF];
+        return this->read_byte_impl(address, false);
+    }
+
+    GBEMU_ALWAYS_INLINE void write_byte(uint16_t address, uint8_t value) {
+        uint8_t *page = this->write_pages_[address >> 8];
+        if (page == nullptr) return this->write_byte_slow(address, value);
+        page[address & 0xFF] = value;
+        if (this->code_pages_ != nullptr && this->code_pages_[address >> k_code_page_shift]) this->invalidate_code(address);
+    }
 
     uint16_t read_word(uint16_t address) const;
     void write_word(uint16_t address, uint16_t value);
@@ -28,10 +76,23 @@ class Memory {
     uint8_t get_if() const;
     void set_if(uint8_t value);
 
-    void attach_joypad(Joypad *joypad);
-    uint8_t read_io_reg(uint16_t address) const;
-    void write_io_reg(uint16_t address, uint8_t value);
-    bool consume_div_reset();
+    void save_state(State &state) const;
+    // Cached blocks on RAM pages whose contents change are dropped, as if the CPU had written them.
+    void load_state(const State &state);
+
+    void set_io_handler(uint16_t address, const IoHandler &handler);
+    void attach_block_cache(BlockCache *block_cache);
+    void attach_mbc(Mbc *mbc);
+
+    // ROM banks for 0x0000-0x3FFF and 0x4000-0x7FFF, wrapped to the size of the ROM. Only repoints page table entries.
+    void map_rom(uint32_t low_bank, uint32_t high_bank);
+    // ROM bank mapped at address, 0 outside the ROM. Cached code is keyed by it.
+    uint16_t rom_bank(uint16_t address) const {
+        if (address > 0x7FFF) return 0;
+        return this->rom_banks_[address >> 14];
+    }
+    // One 8 KiB bank of cartridge RAM for 0xA000-0xBFFF, or nullptr to send accesses to the Mbc.
+    void map_eram(uint8_t *bank);
 
     void set_vram_blocked(bool blocked);
     void set_oam_blocked(bool blocked);
@@ -39,14 +100,43 @@ class Memory {
     uint8_t read_vram_raw(uint16_t address) const;
     uint8_t read_oam_raw(uint16_t address) const;
     void write_oam_raw(uint16_t address, uint8_t value);
-
-    bool consume_dma_request(uint8_t &source_high);
+    // The stored value of an IO register, without going through its handler. For the component that owns it.
+    uint8_t read_io_raw(uint16_t address) const;
+    void write_io_raw(uint16_t address, uint8_t value);
+
+    // Raw backing storage for the JIT, which accesses these regions without going through read_byte/write_byte.
+    uint8_t *wram_data() { return this->wram_.data(); }
+    uint8_t *hram_data() { return this->hram_.data(); }
+    // The ROM as mapped from 0x0000 and how far it runs on contiguously: up to 0x8000 when the two windows hold
+    // consecutive banks, as on a cartridge without a controller, otherwise to the end of the 0x0000-0x3FFF window.
+    const uint8_t *rom_data() const { return this->rom_ + this->rom_offsets_[0]; }
+    size_t rom_size() const;
 
   private:
+    static constexpr size_t k_page_count = 0x100;
+    static constexpr size_t k_io_count = 0x80;
+    static constexpr size_t k_code_page_shift = 6; // BlockCache invalidation granularity
+    static constexpr size_t k_code_page_size = size_t{1} << k_code_page_shift;
+
     uint8_t read_byte_impl(uint16_t address, bool respect_locks) const;
+    void write_byte_slow(uint16_t address, uint8_t value);
+    void invalidate_code(uint16_t address);
+
+    // Rebuild the page table entries of one region after its backing storage or lock state changed.
+    void map_rom_pages();
+    // Offset into the ROM image of an address in 0x0000-0x7FFF under the current banks.
+    size_t rom_offset(uint16_t address) const { return this->rom_offsets_[address >> 14] + (address & 0x3FFF); }
+    void map_vram();
+
+    std::array<const uint8_t *, k_page_count> read_pages_{};
+    std::array<const uint8_t *, k_page_count> unlocked_read_pages_{};
+    std::array<uint8_t *, k_page_count> write_pages_{};
+    const bool *code_pages_ = nullptr;
 
-    std::vector<uint8_t> rom_;
-    std::vector<uint8_t> eram_;
+    const uint8_t *rom_ = nullptr; // Owned by the RomImage, usually a mapping of the file
+    size_t rom_length_ = 0;
+    std::array<uint16_t, 2> rom_banks_ = {0, 1};
+    std::array<size_t, 2> rom_offsets_ = {0, 0x4000};
 
     std::array<uint8_t, 0x2000> vram_{}; // 0x8000-0x9FFF
     std::array<uint8_t, 0x2000> wram_{}; // 0xC000-0xDFFF
@@ -57,9 +147,8 @@ class Memory {
 
     bool vram_blocked_ = false;
     bool oam_blocked_ = false;
-    bool dma_request_pending_ = false;
-    uint8_t dma_source_high_ = 0;
-    bool div_reset_pending_ = false;
 
-    Joypad *joypad_ = nullptr;
+    std::array<IoHandler, k_io_count> io_handlers_{};
+    BlockCache *block_cache_ = nullptr;
+    Mbc *mbc_ = nullptr;
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "memory.hpp"
+#include "scheduler.hpp"
 #include "screen.hpp"
 
 #include <array>
@@ -10,10 +11,52 @@
 
 class PPU {
   public:
-    PPU(Memory &memory, Screen &screen);
-
-    void tick(uint32_t dots);
+    struct State {
+        uint64_t synced_cycle;
+        bool catch_up_requested;
+        int dot_in_scanline;
+        int current_ly;
+        uint8_t mode;
+        bool frame_ready;
+        bool lcd_enabled;
+        bool stat_irq_line;
+        bool scanline_rendered;
+        bool dma_active;
+        uint16_t dma_source_base;
+        uint16_t dma_index;
+        int dma_dot_counter;
+        bool skip_frame;
+    };
+
+    PPU(Memory &memory, Screen &screen, Scheduler &scheduler);
+
+    // Whether the frame in progress is drawn is restored with it, but the frame skip setting for the following
+    // frames is left alone: that belongs to the frontend, not the emulated machine.
+    void save_state(State &state) const;
+    void load_state(const State &state);
+
+    // The PPU runs lazily: it only catches up to the scheduler's current cycle around CPU accesses to IO, and once a
+    // mode or line change has passed, before the CPU touches VRAM/OAM, an interrupt it raises could be taken, or the
+    // frame ends (see CPU::run_until). Between those points nothing it does is observable, so this is bit-identical
+    // to ticking it after every instruction. Registers its next mode/line change and VBlank with the scheduler.
+    void catch_up();
+    // Has the PPU catch up once the current instruction has finished. Used around IO accesses, which can change
+    // LCD state the PPU has to react to.
+    void request_catch_up() { this->catch_up_requested_ = true; }
+    bool catch_up_due() const {
+        return this->catch_up_requested_ || this->scheduler_.now() >= this->scheduler_.event_cycle(SchedulerEvent::PpuMode);
+    }
     bool consume_frame_ready();
+    // Frame skip: frames starting after this call are emulated as usual but not drawn. Taking effect only at the
+    // start of a frame means a frame is always either drawn completely or not at all.
+    void set_skip_frames(bool skip) { this->skip_requested_ = skip; }
+    // Whether the frame that just finished (see consume_frame_ready) was drawn.
+    bool frame_drawn() const { return !this->skip_frame_; }
+
+    // Dots that can be ticked before the next mode or line change (the only points where STAT/VBlank can fire).
+    // 0 while OAM DMA is running, since DMA reads memory every dot.
+    uint32_t dots_until_next_event();
+    bool is_dma_active() const { return this->dma_active; }
 
     // LCD control & status registers
     uint8_t get_lcdc();
@@ -53,6 +96,12 @@ class PPU {
     void set_obp1(uint8_t value);
 
   private:
+    // Writes from the CPU to the registers with side effects: LCDC, STAT, LY and DMA.
+    void write_register(uint16_t address, uint8_t value);
+    void tick(uint32_t dots);
+    // Next dot of the current line on which the mode or line changes.
+    int next_busy_dot() const;
+    void schedule_events();
     void reset_lcd_off_state();
     void request_vblank_interrupt();
     void request_lcd_stat_interrupt();
@@ -69,6 +118,9 @@ class PPU {
 
     Memory &memory_;
     Screen &screen_;
+    Scheduler &scheduler_;
+    uint64_t synced_cycle_ = 0; // Scheduler cycle the PPU has been ticked up to
+    bool catch_up_requested_ = false;
 
     int dot_in_scanline = 0;
     int current_ly = 0;
@@ -85,6 +137,8 @@ class PPU {
     const uint16_t hblank_dots = 204;
 
     bool scanline_rendered = false;
+    bool skip_requested_ = false;
+    bool skip_frame_ = false; // skip_requested_ as of the start of the current frame
 
     bool dma_active = false;
     uint16_t dma_source_base = 0;
@@ -9,45 +9,136 @@ static constexpr uint8_t FLAG_N_MASK = 0x40;
 static constexpr uint8_t FLAG_H_MASK = 0x20;
 static constexpr uint8_t FLAG_C_MASK = 0x10;
 
-class Registers {
+// Operation whose flags are still pending (lazy flags). ADC/SBC/CP reuse Add/Sub with a carry-in,
+// XOR shares Or, and Inc/Dec keep the C bit already in F.
+enum class FlagOp : uint8_t { None, Add, Sub, And, Or, Inc, Dec };
+
+// Each register pair is a union of its 16-bit value and its two 8-bit halves, laid out so the high
+// register overlays the high byte on the host. Anonymous structs are a common extension, not ISO C++.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define GBEMU_REGISTER_PAIR(pair, hi, lo)                                                                                                  \
+    union {                                                                                                                                \
+        uint16_t pair;                                                                                                                     \
+        struct {                                                                                                                           \
+            uint8_t hi;                                                                                                                    \
+            uint8_t lo;                                                                                                                    \
+        };                                                                                                                                 \
+    }
+#else
+#define GBEMU_REGISTER_PAIR(pair, hi, lo)                                                                                                  \
+    union {                                                                                                                                \
+        uint16_t pair;                                                                                                                     \
+        struct {                                                                                                                           \
+            uint8_t lo;                                                                                                                    \
+            uint8_t hi;                                                                                                                    \
+        };                                                                                                                                 \
+    }
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#elif defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable : 4201)
+#endif
+
+class alignas(64) Registers {
   public:
     Registers();
 
-    uint8_t A;
-    uint8_t B;
-    uint8_t C;
-    uint8_t D;
-    uint8_t E;
-    uint8_t F;
-    uint8_t H;
-    uint8_t L;
+    GBEMU_REGISTER_PAIR(AF, A, F);
+    GBEMU_REGISTER_PAIR(BC, B, C);
+    GBEMU_REGISTER_PAIR(DE, D, E);
+    GBEMU_REGISTER_PAIR(HL, H, L);
 
     uint16_t SP;
     uint16_t PC;
 
     bool IME;
 
-    void set_af(uint16_t value);
-    uint16_t get_af();
+    GBEMU_ALWAYS_INLINE void set_af(uint16_t value) {
+        this->AF = static_cast<uint16_t>(value & 0xFFF0);
+        this->flag_op_ = FlagOp::None;
+    }
+    GBEMU_ALWAYS_INLINE uint16_t get_af() {
+        this->materialise_flags();
+        return this->AF;
+    }
+
+    GBEMU_ALWAYS_INLINE constexpr void set_bc(uint16_t value) { this->BC = value; }
+    GBEMU_ALWAYS_INLINE constexpr uint16_t get_bc() const { return this->BC; }
+
+    GBEMU_ALWAYS_INLINE constexpr void set_de(uint16_t value) { this->DE = value; }
+    GBEMU_ALWAYS_INLINE constexpr uint16_t get_de() const { return this->DE; }
+
+    GBEMU_ALWAYS_INLINE constexpr void set_hl(uint16_t value) { this->HL = value; }
+    GBEMU_ALWAYS_INLINE constexpr uint16_t get_hl() const { return this->HL; }
 
-    void set_bc(uint16_t value);
-    uint16_t get_bc();
+    GBEMU_ALWAYS_INLINE void set_flag_z(bool value) { this->set_flag(FLAG_Z_MASK, value); }
+    GBEMU_ALWAYS_INLINE bool get_flag_z() { return this->get_flag(FLAG_Z_MASK); }
 
-    void set_de(uint16_t value);
-    uint16_t get_de();
+    GBEMU_ALWAYS_INLINE void set_flag_n(bool value) { this->set_flag(FLAG_N_MASK, value); }
+    GBEMU_ALWAYS_INLINE bool get_flag_n() { return this->get_flag(FLAG_N_MASK); }
 
-    void set_hl(uint16_t value);
-    uint16_t get_hl();
+    GBEMU_ALWAYS_INLINE void set_flag_h(bool value) { this->set_flag(FLAG_H_MASK, value); }
+    GBEMU_ALWAYS_INLINE bool get_flag_h() { return this->get_flag(FLAG_H_MASK); }
 
-    void set_flag_z(bool value);
-    bool get_flag_z();
+    GBEMU_ALWAYS_INLINE void set_flag_c(bool value) { this->set_flag(FLAG_C_MASK, value); }
+    GBEMU_ALWAYS_INLINE bool get_flag_c() { return this->get_flag(FLAG_C_MASK); }
 
-    void set_flag_n(bool value);
-    bool get_flag_n();
+    // Overwrite all four flags at once, dropping any pending operation.
+    GBEMU_ALWAYS_INLINE void set_flags(bool z, bool n, bool h, bool c) {
+        this->F = static_cast<uint8_t>((z ? FLAG_Z_MASK : 0x00) | (n ? FLAG_N_MASK : 0x00) | (h ? FLAG_H_MASK : 0x00) |
+                                       (c ? FLAG_C_MASK : 0x00));
+        this->flag_op_ = FlagOp::None;
+    }
 
-    void set_flag_h(bool value);
-    bool get_flag_h();
+    // Record an operation instead of computing its flags. For Add/Sub lhs/rhs are the operands,
+    // for the others lhs is the result.
+    GBEMU_ALWAYS_INLINE void defer_flags(FlagOp op, uint8_t lhs, uint8_t rhs = 0, uint8_t carry = 0) {
+        if constexpr (config::k_lazy_flags) {
+            // Inc/Dec leave C alone, so whatever is still pending has to land in F first.
+            if (op == FlagOp::Inc || op == FlagOp::Dec) this->materialise_flags();
+            this->flag_op_ = op;
+            this->flag_lhs_ = lhs;
+            this->flag_rhs_ = rhs;
+            this->flag_carry_ = carry;
+            if constexpr (config::k_debug_mode) this->verify_deferred_flags();
+        }
+    }
 
-    void set_flag_c(bool value);
-    bool get_flag_c();
+  private:
+    FlagOp flag_op_ = FlagOp::None;
+    uint8_t flag_lhs_ = 0;
+    uint8_t flag_rhs_ = 0;
+    uint8_t flag_carry_ = 0;
+
+    GBEMU_ALWAYS_INLINE void set_flag(uint8_t mask, bool value) {
+        this->materialise_flags();
+        this->F = static_cast<uint8_t>((this->F & static_cast<uint8_t>(~mask)) | (value ? mask : 0x00));
+    }
+    GBEMU_ALWAYS_INLINE bool get_flag(uint8_t mask) {
+        this->materialise_flags();
+        return (this->F & mask) != 0;
+    }
+
+    GBEMU_ALWAYS_INLINE void materialise_flags() {
+        if (this->flag_op_ == FlagOp::None) return;
+        this->F = this->evaluate_flags();
+        this->flag_op_ = FlagOp::None;
+    }
+
+    uint8_t evaluate_flags() const;
+    void verify_deferred_flags() const;
 };
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#elif defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#undef GBEMU_REGISTER_PAIR
+
+static_assert(sizeof(Registers) <= 64, "Registers should fit in a single cache line");
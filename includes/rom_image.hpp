@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Read-only contents of a ROM file. Where the platform allows it the file is memory-mapped, so only the banks a game
+// actually touches are paged in; otherwise (or if mapping fails) it is read onto the heap. Memory keeps pointers into
+// it, so it has to outlive the GB it is loaded into.
+class RomImage {
+  public:
+    explicit RomImage(const std::string &filename);
+    ~RomImage();
+    RomImage(const RomImage &) = delete;
+    RomImage &operator=(const RomImage &) = delete;
+
+    const uint8_t *data() const { return this->data_; }
+    size_t size() const { return this->size_; }
+    bool mapped() const { return this->mapped_; }
+
+  private:
+    const uint8_t *data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<uint8_t> heap_; // Backing store when the file is not mapped
+};
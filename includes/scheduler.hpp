@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class SchedulerEvent : uint8_t {
+    PpuMode,       // Next PPU mode or line change (or DMA dot while OAM DMA runs)
+    VBlank,        // Next VBlank start, where a finished frame is handed over
+    TimerOverflow, // Next TIMA overflow
+    Count,
+};
+
+// Upcoming hardware events on the master cycle counter, kept in a min-heap. Components register when their next
+// event is due after each time they are ticked, and the CPU runs freely until the earliest one. Each event has at
+// most one pending occurrence: rescheduling leaves the old heap entry behind, and it is dropped once it surfaces.
+class Scheduler {
+  public:
+    static constexpr uint64_t k_never = UINT64_MAX;
+
+    Scheduler();
+
+    // The master clock: T-states since power-on, including interrupt dispatch. The CPU runs ahead of it within a
+    // batch, and the PPU and timer catch up to it lazily.
+    uint64_t now() const { return this->now_; }
+    void advance(uint32_t cycles) { this->now_ += cycles; }
+
+    void schedule(SchedulerEvent event, uint64_t cycle);
+    // cycles is relative to now(); UINT32_MAX (as returned by the components for "not coming") cancels the event.
+    void schedule_in(SchedulerEvent event, uint32_t cycles);
+    void cancel(SchedulerEvent event);
+
+    // Cycle of the earliest pending event, or k_never.
+    uint64_t next_event_cycle();
+    uint64_t event_cycle(SchedulerEvent event) const { return this->pending_[static_cast<size_t>(event)]; }
+
+    // T-states from now() until cycle, 0 if it is already due and UINT32_MAX if it is further away than that.
+    uint32_t cycles_until(uint64_t cycle) const;
+    uint32_t cycles_until_next_event() { return this->cycles_until(this->next_event_cycle()); }
+
+  private:
+    struct Entry {
+        uint64_t cycle;
+        SchedulerEvent event;
+
+        bool operator>(const Entry &other) const { return this->cycle > other.cycle; }
+    };
+
+    std::vector<Entry> heap_;
+    std::array<uint64_t, static_cast<size_t>(SchedulerEvent::Count)> pending_{};
+    uint64_t now_ = 0;
+};
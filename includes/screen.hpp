@@ -3,23 +3,42 @@
 #include "config.hpp"
 
 #include <SDL2/SDL.h>
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <vector>
 
+// Triple-buffered frame handoff between the emulation thread, which draws into the back buffer, and the display
+// thread, which presents the newest finished frame. Neither side ever waits for the other: publishing swaps the back
+// buffer with the middle one, and presenting swaps the middle one with the front buffer if it holds a newer frame.
 class Screen {
   public:
     Screen();
+
+    // Emulation thread.
     void set(size_t x, size_t y, uint8_t color);
     void clear();
     void draw_logo(const std::vector<uint8_t> &logo);
+    // Hands the back buffer over as the newest finished frame. Drawing continues in a buffer with stale contents.
+    void publish();
 
+    // Display thread.
     void set_renderer(SDL_Renderer *renderer);
     void set_texture(SDL_Texture *texture);
-    void present();
+    // Presents the newest frame published since the last call. False (and nothing is drawn) if there is none.
+    bool present();
 
   private:
-    uint8_t screen_[config::k_screen_width][config::k_screen_height];
+    using Frame = std::array<std::array<uint8_t, config::k_screen_height>, config::k_screen_width>;
+
+    static constexpr uint8_t k_fresh = 0x80; // Set in middle_ while it holds a frame that has not been presented
+
+    std::array<Frame, 3> frames_{};
+    uint8_t back_ = 0;  // Owned by the emulation thread
+    uint8_t front_ = 1; // Owned by the display thread
+    std::atomic<uint8_t> middle_{2};
+
     SDL_Renderer *renderer_ = nullptr;
     SDL_Texture *texture_ = nullptr;
 
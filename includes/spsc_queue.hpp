@@ -0,0 +1,39 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Fixed-size lock-free ring buffer for exactly one producer thread and one consumer thread. Capacity must be a power
+// of two; one slot stays empty to tell a full queue from an empty one.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+  public:
+    // Producer side. False (and the item is dropped) while the queue is full.
+    bool push(const T &item) {
+        const size_t tail = this->tail_.load(std::memory_order_relaxed);
+        const size_t next = (tail + 1) & (Capacity - 1);
+        if (next == this->head_.load(std::memory_order_acquire)) return false;
+
+        this->items_[tail] = item;
+        this->tail_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. False while the queue is empty.
+    bool pop(T &item) {
+        const size_t head = this->head_.load(std::memory_order_relaxed);
+        if (head == this->tail_.load(std::memory_order_acquire)) return false;
+
+        item = this->items_[head];
+        this->head_.store((head + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+
+  private:
+    std::array<T, Capacity> items_{};
+    alignas(64) std::atomic<size_t> head_{0}; // Next slot to pop, written by the consumer
+    alignas(64) std::atomic<size_t> tail_{0}; // Next slot to push, written by the producer
+};
@@ -2,6 +2,7 @@
 
 #include "memory.hpp"
 #include "registers.hpp"
+#include "scheduler.hpp"
 
 #include <cstddef>
 #include <cstdint>
@@ -9,27 +10,56 @@
 
 class Timer {
   public:
-    Timer(Registers &registers, Memory &memory, bool &stopped);
+    struct State {
+        uint8_t div, tima, tma, tac;
+        uint64_t synced_cycle;
+        bool catch_up_requested;
+        bool div_reset_pending;
+        uint16_t div_m_cycles_counter;
+        uint16_t tima_m_cycles_counter;
+    };
 
-    void tick(uint32_t dots);
+    Timer(Registers &registers, Memory &memory, Scheduler &scheduler, bool &stopped);
 
-    uint8_t get_div();
-    void set_div(uint8_t value);
+    void save_state(State &state) const;
+    void load_state(const State &state);
 
-    uint8_t get_tima();
-    void set_tima(uint8_t value);
+    // DIV and TIMA are derived from the scheduler's clock on demand: reads and writes of FF04-FF07 (IO handlers
+    // registered with Memory) first bring them up to the current cycle in one step, and a TIMA overflow is registered with the
+    // scheduler as a single future event, at which the interrupt flag is raised.
+    void catch_up();
+    // Has the timer catch up once the current instruction has finished. A DIV reset or TAC change applies to the
+    // whole instruction that wrote it.
+    void request_catch_up() { this->catch_up_requested_ = true; }
+    bool catch_up_due() const {
+        return this->catch_up_requested_ || this->stopped_ ||
+               this->scheduler_.now() >= this->scheduler_.event_cycle(SchedulerEvent::TimerOverflow);
+    }
 
-    uint8_t get_tma();
-    void set_tma(uint8_t value);
+    // T-states that can be ticked without TIMA overflowing (and raising the timer interrupt).
+    uint32_t cycles_until_overflow() const;
 
-    uint8_t get_tac();
-    void set_tac(uint8_t value);
+    uint8_t read_register(uint16_t address);
+    void write_register(uint16_t address, uint8_t value);
 
   private:
+    void tick(uint64_t m_cycles);
+    void increment_tima(uint64_t increments);
+
     Registers &registers_;
     Memory &memory_;
+    Scheduler &scheduler_;
     bool &stopped_;
 
+    uint8_t div_ = 0;  // 0xFF04
+    uint8_t tima_ = 0; // 0xFF05
+    uint8_t tma_ = 0;  // 0xFF06
+    uint8_t tac_ = 0;  // 0xFF07
+
+    uint64_t synced_cycle_ = 0;
+    bool catch_up_requested_ = false;
+    bool div_reset_pending_ = false;
+
     uint16_t div_m_cycles_counter_ = 0;
     uint16_t tima_m_cycles_counter_ = 0;
 
@@ -8,10 +8,13 @@ void ALU::add_u8(uint8_t val) {
     this->registers_.A = result;
 
     // Flags Z 0 H C
-    this->registers_.set_flag_z(result == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(((a & 0x0F) + (val & 0x0F)) > 0x0F);
-    this->registers_.set_flag_c(static_cast<uint16_t>(a) + static_cast<uint16_t>(val) > 0xFF);
+    if constexpr (config::k_eager_flags) {
+        this->registers_.set_flag_z(result == 0);
+        this->registers_.set_flag_n(false);
+        this->registers_.set_flag_h(((a & 0x0F) + (val & 0x0F)) > 0x0F);
+        this->registers_.set_flag_c(static_cast<uint16_t>(a) + static_cast<uint16_t>(val) > 0xFF);
+    }
+    this->registers_.defer_flags(FlagOp::Add, a, val);
 }
 void ALU::adc_u8(uint8_t val) {
     uint8_t a = this->registers_.A;
@@ -20,10 +23,13 @@ void ALU::adc_u8(uint8_t val) {
     this->registers_.A = result;
 
     // Flags Z 0 H C
-    this->registers_.set_flag_z(result == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(((a & 0x0F) + (val & 0x0F) + c) > 0x0F);
-    this->registers_.set_flag_c(static_cast<uint16_t>(a) + static_cast<uint16_t>(val) + static_cast<uint16_t>(c) > 0xFF);
+    if constexpr (config::k_eager_flags) {
+        this->registers_.set_flag_z(result == 0);
+        this->registers_.set_flag_n(false);
+        this->registers_.set_flag_h(((a & 0x0F) + (val & 0x0F) + c) > 0x0F);
+        this->registers_.set_flag_c(static_cast<uint16_t>(a) + static_cast<uint16_t>(val) + static_cast<uint16_t>(c) > 0xFF);
+    }
+    this->registers_.defer_flags(FlagOp::Add, a, val, c);
 }
 
 void ALU::add_u16(uint16_t val) {
@@ -42,10 +48,13 @@ void ALU::sub_u8(uint8_t val) {
     this->registers_.A = static_cast<uint8_t>(a - val);
 
     // Flags Z 1 H C
-    this->registers_.set_flag_z(this->registers_.A == 0);
-    this->registers_.set_flag_n(true);
-    this->registers_.set_flag_h((val & 0x0F) > (a & 0x0F));
-    this->registers_.set_flag_c(val > a);
+    if constexpr (config::k_eager_flags) {
+        this->registers_.set_flag_z(this->registers_.A == 0);
+        this->registers_.set_flag_n(true);
+        this->registers_.set_flag_h((val & 0x0F) > (a & 0x0F));
+        this->registers_.set_flag_c(val > a);
+    }
+    this->registers_.defer_flags(FlagOp::Sub, a, val);
 }
 void ALU::sbc_u8(uint8_t val) {
     uint8_t a = this->registers_.A;
@@ -53,10 +62,13 @@ void ALU::sbc_u8(uint8_t val) {
     this->registers_.A = static_cast<uint8_t>(a - val - c);
 
     // Flags Z 1 H C
-    this->registers_.set_flag_z(this->registers_.A == 0);
-    this->registers_.set_flag_n(true);
-    this->registers_.set_flag_h(((val & 0x0F) + c) > (a & 0x0F));
-    this->registers_.set_flag_c((static_cast<uint16_t>(val) + static_cast<uint16_t>(c)) > static_cast<uint16_t>(a));
+    if constexpr (config::k_eager_flags) {
+        this->registers_.set_flag_z(this->registers_.A == 0);
+        this->registers_.set_flag_n(true);
+        this->registers_.set_flag_h(((val & 0x0F) + c) > (a & 0x0F));
+        this->registers_.set_flag_c((static_cast<uint16_t>(val) + static_cast<uint16_t>(c)) > static_cast<uint16_t>(a));
+    }
+    this->registers_.defer_flags(FlagOp::Sub, a, val, c);
 }
 
 void ALU::and_u8(uint8_t val) {
@@ -64,30 +76,39 @@ void ALU::and_u8(uint8_t val) {
     this->registers_.A = result;
 
     // Flags Z 0 1 0
-    this->registers_.set_flag_z(result == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(true);
-    this->registers_.set_flag_c(false);
+    if constexpr (config::k_eager_flags) {
+        this->registers_.set_flag_z(result == 0);
+        this->registers_.set_flag_n(false);
+        this->registers_.set_flag_h(true);
+        this->registers_.set_flag_c(false);
+    }
+    this->registers_.defer_flags(FlagOp::And, result);
 }
 void ALU::or_u8(uint8_t val) {
     uint8_t result = this->registers_.A | val;
     this->registers_.A = result;
 
     // Flags Z 0 0 0
-    this->registers_.set_flag_z(result == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(false);
+    if constexpr (config::k_eager_flags) {
+        this->registers_.set_flag_z(result == 0);
+        this->registers_.set_flag_n(false);
+        this->registers_.set_flag_h(false);
+        this->registers_.set_flag_c(false);
+    }
+    this->registers_.defer_flags(FlagOp::Or, result);
 }
 void ALU::xor_u8(uint8_t val) {
     uint8_t result = this->registers_.A ^ val;
     this->registers_.A = result;
 
     // Flags Z 0 0 0
-    this->registers_.set_flag_z(result == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(false);
+    if constexpr (config::k_eager_flags) {
+        this->registers_.set_flag_z(result == 0);
+        this->registers_.set_flag_n(false);
+        this->registers_.set_flag_h(false);
+        this->registers_.set_flag_c(false);
+    }
+    this->registers_.defer_flags(FlagOp::Or, result);
 }
 
 void ALU::cp_u8(uint8_t val) {
@@ -95,8 +116,11 @@ void ALU::cp_u8(uint8_t val) {
     uint8_t result = static_cast<uint8_t>(a - val);
 
     // Flags Z 1 H C
-    this->registers_.set_flag_z(result == 0);
-    this->registers_.set_flag_n(true);
-    this->registers_.set_flag_h((val & 0x0F) > (a & 0x0F));
-    this->registers_.set_flag_c(val > a);
+    if constexpr (config::k_eager_flags) {
+        this->registers_.set_flag_z(result == 0);
+        this->registers_.set_flag_n(true);
+        this->registers_.set_flag_h((val & 0x0F) > (a & 0x0F));
+        this->registers_.set_flag_c(val > a);
+    }
+    this->registers_.defer_flags(FlagOp::Sub, a, val);
 }
@@ -0,0 +1,320 @@
+#include "block_cache.hpp"
+#include "memory.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+
+namespace {
+// clang-format off
+constexpr std::array<uint8_t, 256> k_lengths = {
+    1, 3, 1, 1, 1, 1, 2, 1, 3, 1, 1, 1, 1, 1, 2, 1, // 0x00
+    2, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1, // 0x10
+    2, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1, // 0x20
+    2, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1, // 0x30
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x40
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x50
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x60
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x70
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x80
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x90
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0xa0
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0xb0
+    1, 1, 3, 3, 3, 1, 2, 1, 1, 1, 3, 2, 3, 3, 2, 1, // 0xc0
+    1, 1, 3, 1, 3, 1, 2, 1, 1, 1, 3, 1, 3, 1, 2, 1, // 0xd0
+    2, 1, 1, 1, 1, 1, 2, 1, 2, 1, 3, 1, 1, 1, 2, 1, // 0xe0
+    2, 1, 1, 1, 1, 1, 2, 1, 2, 1, 3, 1, 1, 1, 2, 1, // 0xf0
+};
+
+// Not-taken timings for conditional branches; 0 marks the unused opcodes.
+constexpr std::array<uint8_t, 256> k_cycles = {
+     4, 12,  8,  8,  4,  4,  8,  4, 20,  8,  8,  8,  4,  4,  8,  4, // 0x00
+     4, 12,  8,  8,  4,  4,  8,  4, 12,  8,  8,  8,  4,  4,  8,  4, // 0x10
+     8, 12,  8,  8,  4,  4,  8,  4,  8,  8,  8,  8,  4,  4,  8,  4, // 0x20
+     8, 12,  8,  8, 12, 12, 12,  4,  8,  8,  8,  8,  4,  4,  8,  4, // 0x30
+     4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // 0x40
+     4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // 0x50
+     4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // 0x60
+     8,  8,  8,  8,  8,  8,  4,  8,  4,  4,  4,  4,  4,  4,  8,  4, // 0x70
+     4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // 0x80
+     4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // 0x90
+     4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // 0xa0
+     4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // 0xb0
+     8, 12, 12, 16, 12, 16,  8, 16,  8, 16, 12,  8, 12, 24,  8, 16, // 0xc0
+     8, 12, 12,  0, 12, 16,  8, 16,  8, 16, 12,  0, 12,  0,  8, 16, // 0xd0
+    12, 12,  8,  0,  0, 16,  8, 16, 16,  4, 16,  0,  0,  0,  8, 16, // 0xe0
+    12, 12,  8,  4,  0, 16,  8, 16, 12,  8, 16,  4,  0,  0,  8, 16, // 0xf0
+};
+// clang-format on
+
+constexpr uint16_t k_rom_end = 0x7FFF;
+constexpr uint16_t k_banked_rom_start = 0x4000;
+constexpr uint16_t k_wram_start = 0xC000;
+constexpr uint16_t k_wram_end = 0xDFFF;
+constexpr uint16_t k_hram_start = 0xFF80;
+constexpr uint16_t k_hram_end = 0xFFFE;
+
+// Instructions after which execution does not simply fall through to the next byte.
+constexpr bool ends_block(uint8_t opcode) {
+    switch (opcode) {
+    case 0x10: // STOP
+    case 0x18: // JR
+    case 0x20:
+    case 0x28:
+    case 0x30:
+    case 0x38:
+    case 0x76: // HALT
+    case 0xC0: // RET
+    case 0xC8:
+    case 0xC9:
+    case 0xD0:
+    case 0xD8:
+    case 0xD9:
+    case 0xC2: // JP
+    case 0xC3:
+    case 0xCA:
+    case 0xD2:
+    case 0xDA:
+    case 0xE9:
+    case 0xC4: // CALL
+    case 0xCC:
+    case 0xCD:
+    case 0xD4:
+    case 0xDC:
+    case 0xC7: // RST
+    case 0xCF:
+    case 0xD7:
+    case 0xDF:
+    case 0xE7:
+    case 0xEF:
+    case 0xF7:
+    case 0xFF:
+        return true;
+    default:
+        return k_cycles[opcode] == 0; // Unused opcodes trap in the interpreter
+    }
+}
+
+// Loads into A whose address does not depend on registers the loop could change.
+constexpr bool is_poll_load(uint8_t opcode) {
+    switch (opcode) {
+    case 0x0A: // LD A, [BC]
+    case 0x1A: // LD A, [DE]
+    case 0x7E: // LD A, [HL]
+    case 0xF0: // LDH A, [a8]
+    case 0xF2: // LDH A, [C]
+    case 0xFA: // LD A, [a16]
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Instructions that only derive A and all flags they set from A, registers the loop leaves alone, or immediates.
+constexpr bool is_poll_test(const MicroOp &op) {
+    const uint8_t opcode = op.opcode;
+    if (opcode == 0x00) return true; // NOP
+    if (opcode >= 0xA0 && opcode <= 0xBF && (opcode & 0x07) != 6) return true; // AND/XOR/OR/CP r
+    if (opcode == 0xE6 || opcode == 0xEE || opcode == 0xF6 || opcode == 0xFE) return true; // AND/XOR/OR/CP n8
+    if (opcode == 0xCB) {
+        const uint8_t cb = static_cast<uint8_t>(op.imm);
+        // BIT b, A. It leaves C as it was: either an AND/XOR/OR/CP earlier in the loop sets it from the same inputs
+        // every time, or it stays whatever it was on entry, so every iteration still ends with the same flags.
+        return (cb & 0xC7) == 0x47;
+    }
+    return false;
+}
+
+// T-states per iteration if the block ends in a conditional JR/JP back to its own start, 0 otherwise.
+uint16_t self_loop_cycles(const Block &block) {
+    const MicroOp &branch = block.ops.back();
+    uint16_t target = 0;
+    switch (branch.opcode) {
+    case 0x20: // JR cc, e8
+    case 0x28:
+    case 0x30:
+    case 0x38:
+        target = static_cast<uint16_t>(branch.pc + branch.length + static_cast<int8_t>(branch.imm));
+        break;
+    case 0xC2: // JP cc, a16
+    case 0xCA:
+    case 0xD2:
+    case 0xDA:
+        target = branch.imm;
+        break;
+    default:
+        return 0;
+    }
+    if (target != block.start) return 0;
+
+    uint32_t cycles = 4; // Taken branch
+    for (const MicroOp &op : block.ops) {
+        cycles += op.cycles;
+    }
+    return static_cast<uint16_t>(cycles);
+}
+
+bool is_poll_loop(const Block &block) {
+    if (block.ops.size() < 2 || !is_poll_load(block.ops.front().opcode)) return false;
+    for (size_t i = 1; i + 1 < block.ops.size(); ++i) {
+        if (!is_poll_test(block.ops[i])) return false;
+    }
+    return true;
+}
+
+// Matches the loop body (everything before the branch) against the memset/memcpy shapes the CPU runs in bulk.
+// All of them count down to zero and loop on NZ. Only ROM loops qualify, so the loop cannot overwrite itself.
+BulkLoop bulk_loop_kind(const Block &block) {
+    const uint8_t branch = block.ops.back().opcode;
+    if (block.start > k_rom_end || (branch != 0x20 && branch != 0xC2)) return BulkLoop::None;
+
+    std::vector<uint8_t> body;
+    for (size_t i = 0; i + 1 < block.ops.size(); ++i) {
+        body.push_back(block.ops[i].opcode);
+    }
+    const auto is_dec_bcde = [](uint8_t opcode) { return opcode == 0x05 || opcode == 0x0D || opcode == 0x15 || opcode == 0x1D; };
+
+    if (body.size() == 2 && (body[0] == 0x22 || body[0] == 0x32) && is_dec_bcde(body[1])) return BulkLoop::Fill8;
+    if (body.size() == 4 && (body[0] == 0x2A || body[0] == 0x3A) && body[1] == 0x12 && body[2] == 0x13 &&
+        (body[3] == 0x05 || body[3] == 0x0D)) {
+        return BulkLoop::Copy8;
+    }
+    if (body.size() == 5 && (body[0] == 0x3E || body[0] == 0xAF) && (body[1] == 0x22 || body[1] == 0x32) && body[2] == 0x0B &&
+        body[3] == 0x78 && body[4] == 0xB1) {
+        return BulkLoop::Fill16;
+    }
+    if (body.size() == 6 && (body[0] == 0x2A || body[0] == 0x3A) && body[1] == 0x12 && body[2] == 0x13 && body[3] == 0x0B &&
+        body[4] == 0x78 && body[5] == 0xB1) {
+        return BulkLoop::Copy16;
+    }
+    return BulkLoop::None;
+}
+
+// Last address of the cacheable region containing address, or 0 if code there is not cached
+// (VRAM/OAM can be locked by the PPU, external RAM and IO are not plain memory, echo RAM is rare).
+constexpr uint16_t cacheable_region_end(uint16_t address) {
+    if (address < k_banked_rom_start) return k_banked_rom_start - 1; // Blocks never straddle two banks
+    if (address <= k_rom_end) return k_rom_end;
+    if (address >= k_wram_start && address <= k_wram_end) return k_wram_end;
+    if (address >= k_hram_start && address <= k_hram_end) return k_hram_end;
+    return 0;
+}
+} // namespace
+
+BlockCache::BlockCache(Memory &memory) : memory_(memory) {}
+
+uint8_t BlockCache::length(uint8_t opcode) { return k_lengths[opcode]; }
+
+MicroOp BlockCache::decode(const Memory &memory, uint16_t pc) {
+    MicroOp op{};
+    op.pc = pc;
+    op.opcode = memory.read_byte(pc);
+    op.length = k_lengths[op.opcode];
+    op.cycles = k_cycles[op.opcode];
+
+    op.imm = read_immediate(memory, pc, op.length);
+
+    if (op.opcode == 0xCB) {
+        const uint8_t cb = static_cast<uint8_t>(op.imm);
+        const bool is_hlm = (cb & 0x07) == 6;
+        const bool is_bit = (cb >> 6) == 1;
+        op.cycles = is_hlm ? (is_bit ? 12 : 16) : 8;
+    }
+    return op;
+}
+
+uint16_t BlockCache::read_immediate(const Memory &memory, uint16_t pc, uint8_t length) {
+    uint16_t imm = 0;
+    if (length >= 2) imm = memory.read_byte(static_cast<uint16_t>(pc + 1));
+    if (length == 3) imm = static_cast<uint16_t>(imm | (memory.read_byte(static_cast<uint16_t>(pc + 2)) << 8));
+    return imm;
+}
+
+uint16_t BlockCache::bank(uint16_t pc) const { return this->memory_.rom_bank(pc); }
+
+const Block *BlockCache::lookup(uint16_t pc) {
+    const uint16_t region_end = cacheable_region_end(pc);
+    if (region_end == 0) return nullptr;
+
+    this->lookups_ += 1;
+    const uint16_t block_bank = this->bank(pc);
+    Block *recent = this->by_pc_[pc];
+    if (recent != nullptr && recent->bank == block_bank) {
+        this->hits_ += 1;
+        return recent;
+    }
+
+    const uint32_t block_key = (static_cast<uint32_t>(block_bank) << 16) | pc;
+    auto found = this->blocks_.find(block_key);
+    if (found != this->blocks_.end()) {
+        this->hits_ += 1;
+        this->by_pc_[pc] = &found->second;
+        return &found->second;
+    }
+
+    Block block{block_bank, pc, pc, {}, 0, false, BulkLoop::None};
+    uint32_t address = pc;
+    while (block.ops.size() < k_max_block_ops) {
+        const uint8_t opcode = this->memory_.read_byte(static_cast<uint16_t>(address));
+        // The whole instruction has to sit inside the region; the interpreter handles anything straddling it.
+        if (address + k_lengths[opcode] - 1 > region_end) break;
+
+        const MicroOp op = decode(this->memory_, static_cast<uint16_t>(address));
+        block.ops.push_back(op);
+        address += op.length;
+        if (ends_block(op.opcode) || address > region_end) break;
+    }
+    if (block.ops.empty()) return nullptr;
+    block.end = static_cast<uint16_t>(address);
+    block.loop_cycles = self_loop_cycles(block);
+    if (block.loop_cycles != 0) {
+        block.poll_loop = is_poll_loop(block);
+        block.bulk_loop = bulk_loop_kind(block);
+    }
+
+    if (pc > k_rom_end) {
+        for (size_t page = pc >> k_page_shift; page <= ((address - 1) >> k_page_shift); ++page) {
+            this->code_pages_[page] = true;
+            this->page_blocks_[page].push_back(block_key);
+        }
+    }
+
+    Block *inserted = &this->blocks_.emplace(block_key, std::move(block)).first->second;
+    this->by_pc_[pc] = inserted;
+    return inserted;
+}
+
+void BlockCache::invalidate_page(size_t page) {
+    const std::vector<uint32_t> block_keys = std::move(this->page_blocks_[page]);
+    this->page_blocks_[page].clear();
+    this->code_pages_[page] = false;
+
+    for (const uint32_t block_key : block_keys) {
+        const auto it = this->blocks_.find(block_key);
+        if (it == this->blocks_.end()) continue;
+
+        // A block spanning several pages is registered on each of them; drop it from the others too, so they neither
+        // pile up stale keys nor keep invalidating on writes.
+        const Block &block = it->second;
+        for (size_t other = block.start >> k_page_shift; other <= static_cast<size_t>((block.end - 1) >> k_page_shift); ++other) {
+            if (other == page) continue;
+            std::vector<uint32_t> &keys = this->page_blocks_[other];
+            keys.erase(std::remove(keys.begin(), keys.end(), block_key), keys.end());
+            if (keys.empty()) this->code_pages_[other] = false;
+        }
+
+        this->by_pc_[block_key & 0xFFFF] = nullptr; // RAM blocks are never banked
+        this->blocks_.erase(it);
+    }
+    this->generation_ += 1;
+}
+
+void BlockCache::clear() {
+    this->blocks_.clear();
+    this->by_pc_.fill(nullptr);
+    this->code_pages_.fill(false);
+    for (auto &keys : this->page_blocks_) {
+        keys.clear();
+    }
+    this->generation_ += 1;
+}
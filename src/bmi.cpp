@@ -8,20 +8,14 @@ void BMI::rla() {
     this->registers_.A = static_cast<uint8_t>((this->registers_.A << 1) | carry_in);
 
     // Flags 0 0 0 C
-    this->registers_.set_flag_z(false);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(new_carry != 0);
+    this->registers_.set_flags(false, false, false, new_carry != 0);
 }
 void BMI::rlca() {
     uint8_t old_a_in = this->registers_.A & 0x80;
     this->registers_.A = static_cast<uint8_t>((this->registers_.A << 1) | (old_a_in >> 7));
 
     // Flags 0 0 0 C
-    this->registers_.set_flag_z(false);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(old_a_in != 0);
+    this->registers_.set_flags(false, false, false, old_a_in != 0);
 }
 void BMI::rl_u8(uint8_t &reg) {
     uint8_t carry_in = this->registers_.get_flag_c() ? 1 : 0;
@@ -29,10 +23,7 @@ void BMI::rl_u8(uint8_t &reg) {
     reg = static_cast<uint8_t>((reg << 1) | carry_in);
 
     // Flags Z 0 0 C
-    this->registers_.set_flag_z(reg == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(new_carry != 0);
+    this->registers_.set_flags(reg == 0, false, false, new_carry != 0);
 }
 void BMI::rl_u8(uint16_t address) {
     uint8_t value = this->memory_.read_byte(address);
@@ -42,20 +33,14 @@ void BMI::rl_u8(uint16_t address) {
     this->memory_.write_byte(address, value);
 
     // Flags Z 0 0 C
-    this->registers_.set_flag_z(value == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(new_carry != 0);
+    this->registers_.set_flags(value == 0, false, false, new_carry != 0);
 }
 void BMI::rlc_u8(uint8_t &reg) {
     uint8_t old_reg_in = reg & 0x80;
     reg = static_cast<uint8_t>((reg << 1) | (old_reg_in >> 7));
 
     // Flags Z 0 0 C
-    this->registers_.set_flag_z(reg == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(old_reg_in != 0);
+    this->registers_.set_flags(reg == 0, false, false, old_reg_in != 0);
 }
 void BMI::rlc_u8(uint16_t address) {
     uint8_t value = this->memory_.read_byte(address);
@@ -64,10 +49,7 @@ void BMI::rlc_u8(uint16_t address) {
     this->memory_.write_byte(address, value);
 
     // Flags Z 0 0 C
-    this->registers_.set_flag_z(value == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(old_value_in != 0);
+    this->registers_.set_flags(value == 0, false, false, old_value_in != 0);
 }
 
 void BMI::rra() {
@@ -76,20 +58,14 @@ void BMI::rra() {
     this->registers_.A = static_cast<uint8_t>((this->registers_.A >> 1) | (carry_in << 7));
 
     // Flags 0 0 0 C
-    this->registers_.set_flag_z(false);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(new_carry != 0);
+    this->registers_.set_flags(false, false, false, new_carry != 0);
 }
 void BMI::rrca() {
     uint8_t old_a_in = this->registers_.A & 0x01;
     this->registers_.A = static_cast<uint8_t>((this->registers_.A >> 1) | (old_a_in << 7));
 
     // Flags 0 0 0 C
-    this->registers_.set_flag_z(false);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(old_a_in != 0);
+    this->registers_.set_flags(false, false, false, old_a_in != 0);
 }
 void BMI::rr_u8(uint8_t &reg) {
     uint8_t carry_in = this->registers_.get_flag_c() ? 1 : 0;
@@ -97,10 +73,7 @@ void BMI::rr_u8(uint8_t &reg) {
     reg = static_cast<uint8_t>((reg >> 1) | (carry_in << 7));
 
     // Flags Z 0 0 C
-    this->registers_.set_flag_z(reg == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(new_carry != 0);
+    this->registers_.set_flags(reg == 0, false, false, new_carry != 0);
 }
 void BMI::rr_u8(uint16_t address) {
     uint8_t value = this->memory_.read_byte(address);
@@ -110,20 +83,14 @@ void BMI::rr_u8(uint16_t address) {
     this->memory_.write_byte(address, value);
 
     // Flags Z 0 0 C
-    this->registers_.set_flag_z(value == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(new_carry != 0);
+    this->registers_.set_flags(value == 0, false, false, new_carry != 0);
 }
 void BMI::rrc_u8(uint8_t &reg) {
     uint8_t old_reg_in = reg & 0x01;
     reg = static_cast<uint8_t>((reg >> 1) | (old_reg_in << 7));
 
     // Flags Z 0 0 C
-    this->registers_.set_flag_z(reg == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(old_reg_in != 0);
+    this->registers_.set_flags(reg == 0, false, false, old_reg_in != 0);
 }
 void BMI::rrc_u8(uint16_t address) {
     uint8_t value = this->memory_.read_byte(address);
@@ -132,10 +99,7 @@ void BMI::rrc_u8(uint16_t address) {
     this->memory_.write_byte(address, value);
 
     // Flags Z 0 0 C
-    this->registers_.set_flag_z(value == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(old_value_in != 0);
+    this->registers_.set_flags(value == 0, false, false, old_value_in != 0);
 }
 
 void BMI::sla_u8(uint8_t &reg) {
@@ -143,10 +107,7 @@ void BMI::sla_u8(uint8_t &reg) {
     reg = static_cast<uint8_t>(reg << 1);
 
     // Flags Z 0 0 C
-    this->registers_.set_flag_z(reg == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(new_carry != 0);
+    this->registers_.set_flags(reg == 0, false, false, new_carry != 0);
 }
 void BMI::sla_u8(uint16_t address) {
     uint8_t value = this->memory_.read_byte(address);
@@ -155,10 +116,7 @@ void BMI::sla_u8(uint16_t address) {
     this->memory_.write_byte(address, value);
 
     // Flags Z 0 0 C
-    this->registers_.set_flag_z(value == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(new_carry != 0);
+    this->registers_.set_flags(value == 0, false, false, new_carry != 0);
 }
 
 void BMI::sra_u8(uint8_t &reg) {
@@ -167,10 +125,7 @@ void BMI::sra_u8(uint8_t &reg) {
     reg = static_cast<uint8_t>((reg >> 1) | msb);
 
     // Flags Z 0 0 C
-    this->registers_.set_flag_z(reg == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(new_carry != 0);
+    this->registers_.set_flags(reg == 0, false, false, new_carry != 0);
 }
 void BMI::sra_u8(uint16_t address) {
     uint8_t value = this->memory_.read_byte(address);
@@ -180,10 +135,7 @@ void BMI::sra_u8(uint16_t address) {
     this->memory_.write_byte(address, value);
 
     // Flags Z 0 0 C
-    this->registers_.set_flag_z(value == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(new_carry != 0);
+    this->registers_.set_flags(value == 0, false, false, new_carry != 0);
 }
 
 void BMI::srl_u8(uint8_t &reg) {
@@ -191,10 +143,7 @@ void BMI::srl_u8(uint8_t &reg) {
     reg = static_cast<uint8_t>(reg >> 1);
 
     // Flags Z 0 0 C
-    this->registers_.set_flag_z(reg == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(new_carry != 0);
+    this->registers_.set_flags(reg == 0, false, false, new_carry != 0);
 }
 void BMI::srl_u8(uint16_t address) {
     uint8_t value = this->memory_.read_byte(address);
@@ -203,10 +152,7 @@ void BMI::srl_u8(uint16_t address) {
     this->memory_.write_byte(address, value);
 
     // Flags Z 0 0 C
-    this->registers_.set_flag_z(value == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(new_carry != 0);
+    this->registers_.set_flags(value == 0, false, false, new_carry != 0);
 }
 
 void BMI::swap_u8(uint8_t &reg) {
@@ -215,10 +161,7 @@ void BMI::swap_u8(uint8_t &reg) {
     reg = static_cast<uint8_t>(upper_nibble | lower_nibble);
 
     // Flags Z 0 0 0
-    this->registers_.set_flag_z(reg == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(false);
+    this->registers_.set_flags(reg == 0, false, false, false);
 }
 void BMI::swap_u8(uint16_t address) {
     uint8_t value = this->memory_.read_byte(address);
@@ -228,10 +171,7 @@ void BMI::swap_u8(uint16_t address) {
     this->memory_.write_byte(address, value);
 
     // Flags Z 0 0 0
-    this->registers_.set_flag_z(value == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(false);
+    this->registers_.set_flags(value == 0, false, false, false);
 }
 
 void BMI::bit_u8(uint8_t bit, uint8_t &reg) {
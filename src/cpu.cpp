@@ -1,23 +1,30 @@
 #include "cpu.hpp"
 #include "alu.hpp"
+#include "block_cache.hpp"
 #include "bmi.hpp"
 #include "config.hpp"
 #include "idu.hpp"
+#include "jit.hpp"
 #include "memory.hpp"
 #include "ppu.hpp"
 #include "registers.hpp"
 #include "screen.hpp"
 #include "stack.hpp"
+#include "timer.hpp"
 
 #include <SDL2/SDL.h>
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
 #include <stdexcept>
 #include <vector>
 
-CPU::CPU(Registers &registers, Memory &memory, Stack &stack, IDU &idu, ALU &alu, BMI &bmi, PPU &ppu)
-    : registers_(registers), memory_(memory), stack_(stack), idu_(idu), alu_(alu), bmi_(bmi), ppu_(ppu) {
+CPU::CPU(Registers &registers, Memory &memory, Stack &stack, IDU &idu, ALU &alu, BMI &bmi, PPU &ppu, BlockCache &block_cache,
+         Scheduler &scheduler)
+    : registers_(registers), memory_(memory), stack_(stack), idu_(idu), alu_(alu), bmi_(bmi), ppu_(ppu), block_cache_(block_cache),
+      scheduler_(scheduler) {
     this->init(); // Initialize opcode tables
 }
 
@@ -28,19 +35,210 @@ uint32_t CPU::step() {
     }
 
     if (this->halted || this->stopped) {
-        this->tstates += 4;
-        return 4;
+        // Nothing can wake the CPU before the next PPU mode/line change or TIMA overflow, so jump straight there
+        // (in whole M-cycles, as the timer counts them). The cap keeps joypad wake-ups responsive with the LCD off.
+        const uint32_t cycles = std::max(this->event_horizon() & ~3U, 4U);
+        this->tstates += cycles;
+        return cycles;
     }
 
-    const uint64_t before = this->tstates;
+    // Translated blocks are only entered where the interpreter would start a new block, and never with
+    // a pending HALT bug or EI delay, which the translator does not model.
+    if (this->at_block_start() && !this->halt_bug_active && this->ime_enable_delay == 0) {
+        uint32_t cycles = this->run_loop_shortcut();
+        if (cycles == 0 && this->jit_ != nullptr) cycles = this->run_jit_block();
+        if (cycles > 0) return cycles;
+    }
+
+    return this->interpret();
+}
+
+void CPU::save_state(State &state) const {
+    state = {.stopped = this->stopped,
+             .halted = this->halted,
+             .ime_enable_delay = this->ime_enable_delay,
+             .halt_bug_active = this->halt_bug_active};
+}
+
+void CPU::load_state(const State &state) {
+    this->stopped = state.stopped;
+    this->halted = state.halted;
+    this->ime_enable_delay = state.ime_enable_delay;
+    this->halt_bug_active = state.halt_bug_active;
+    this->block_cursor_ = nullptr;
+    this->block_end_ = nullptr;
+}
+
+bool CPU::at_block_start() const {
+    return this->block_generation_ != this->block_cache_.generation() || this->block_cursor_ == this->block_end_ ||
+           this->block_cursor_->pc != this->registers_.PC || this->block_cursor_ == this->block_->ops.data();
+}
+
+namespace {
+constexpr bool is_io(uint32_t address) {
+    address &= 0xFFFF;
+    return (address >= 0xFF00 && address <= 0xFF7F) || address == 0xFFFF;
+}
+
+constexpr bool is_video(uint32_t address) {
+    address &= 0xFFFF;
+    return (address >= 0x8000 && address <= 0x9FFF) || (address >= 0xFE00 && address <= 0xFEFF);
+}
+} // namespace
+
+template <typename AddressPredicate> bool CPU::accesses_memory(const MicroOp &op, AddressPredicate matches) const {
+    const uint16_t sp = this->registers_.SP;
+
+    switch (op.opcode) {
+    case 0xE0: // LDH [a8], A / LDH A, [a8]
+    case 0xF0:
+        return matches(0xFF00U | (op.imm & 0xFF));
+    case 0xE2: // LDH [C], A / LDH A, [C]
+    case 0xF2:
+        return matches(0xFF00U | this->registers_.C);
+    case 0xEA: // LD [a16], A / LD A, [a16]
+    case 0xFA:
+        return matches(op.imm);
+    case 0x08: // LD [a16], SP
+        return matches(op.imm) || matches(op.imm + 1U);
+    case 0x02:
+    case 0x0A:
+        return matches(this->registers_.get_bc());
+    case 0x12:
+    case 0x1A:
+        return matches(this->registers_.get_de());
+    case 0x22:
+    case 0x2A:
+    case 0x32:
+    case 0x3A:
+    case 0x34:
+    case 0x35:
+    case 0x36:
+        return matches(this->registers_.get_hl());
+    case 0xCB:
+        return (op.imm & 0x07) == 6 && matches(this->registers_.get_hl());
+    case 0xC1: // POP, RET, RETI
+    case 0xD1:
+    case 0xE1:
+    case 0xF1:
+    case 0xC0:
+    case 0xC8:
+    case 0xC9:
+    case 0xD0:
+    case 0xD8:
+    case 0xD9:
+        return matches(sp) || matches(sp + 1U);
+    case 0xC5: // PUSH, CALL, RST
+    case 0xD5:
+    case 0xE5:
+    case 0xF5:
+    case 0xC4:
+    case 0xCC:
+    case 0xCD:
+    case 0xD4:
+    case 0xDC:
+    case 0xC7:
+    case 0xCF:
+    case 0xD7:
+    case 0xDF:
+    case 0xE7:
+    case 0xEF:
+    case 0xF7:
+    case 0xFF:
+        return matches(sp - 1U) || matches(sp - 2U);
+    default:
+        break;
+    }
+
+    // LD r, [HL] / LD [HL], r / ALU A, [HL]
+    if (op.opcode >= 0x40 && op.opcode <= 0xBF && ((op.opcode & 0x07) == 6 || (op.opcode & 0xF8) == 0x70)) {
+        return matches(this->registers_.get_hl());
+    }
+    return false;
+}
+
+uint32_t CPU::run_until(uint64_t target_cycle) {
+    // The batch runs without the PPU and timer being ticked. Every instruction after the first has to start before
+    // any interrupt that could be taken is raised, and before the next VBlank, where the frame is handed over. Past
+    // a PPU mode change VRAM/OAM locks and rendering are out of date, so the batch also ends at the first access to
+    // video memory after one. The first instruction is exactly what step() would do, so progress is always made.
+    this->tstates = 0;
+    if (this->halted || this->stopped || this->halt_bug_active) return this->step();
+    if (this->needs_sync(this->peek())) {
+        // The PPU and timer have to be current when the access happens, and see its effect right after.
+        this->ppu_.catch_up();
+        this->ppu_.request_catch_up();
+        this->timer_->catch_up();
+        this->timer_->request_catch_up();
+        return this->step();
+    }
+
+    // Targets and event cycles are on the master clock, which is still at the start of the batch.
+    const uint64_t now = this->scheduler_.now();
+    const bool interruptible = this->registers_.IME;
+    const uint64_t ppu_event = this->scheduler_.event_cycle(SchedulerEvent::PpuMode);
+    uint64_t end = std::min({target_cycle, this->scheduler_.event_cycle(SchedulerEvent::VBlank), this->next_interrupt_event()});
+    if (this->ppu_.is_dma_active()) end = now; // OAM DMA reads and writes memory on every dot
+
+    uint32_t cycles = this->step();
+    // A translated block that called back into Memory has already advanced the master clock over part of its span.
+    if (cycles != this->tstates) return cycles;
+
+    while (now + cycles < end) {
+        if (this->halted || this->stopped || this->halt_bug_active) break;
+        if (this->ime_enable_delay != 0 || this->registers_.IME != interruptible) break;
+        const MicroOp next = this->peek();
+        if (this->needs_sync(next)) break;
+        if (now + cycles >= ppu_event && this->accesses_memory(next, is_video)) break;
+        // Loop shortcuts and translated blocks size themselves against the PPU/timer state, so they start batches.
+        if (this->block_cursor_ != nullptr && this->block_cursor_ == this->block_->ops.data() &&
+            (this->block_->poll_loop || this->block_->bulk_loop != BulkLoop::None || this->jit_ != nullptr)) {
+            break;
+        }
+        cycles += this->interpret();
+    }
+    return cycles;
+}
+
+bool CPU::needs_sync(const MicroOp &op) const {
+    switch (op.opcode) {
+    case 0x10: // STOP, HALT, DI, EI change how the next instructions run
+    case 0x76:
+    case 0xF3:
+    case 0xFB:
+        return true;
+    default:
+        return this->accesses_memory(op, is_io);
+    }
+}
+
+uint64_t CPU::next_interrupt_event() {
+    if (!this->registers_.IME) return Scheduler::k_never;
+
+    const uint8_t enabled = this->memory_.get_ie();
+    uint64_t event = Scheduler::k_never;
+    if ((enabled & 0x01) != 0) event = this->scheduler_.event_cycle(SchedulerEvent::VBlank);
+    if ((enabled & 0x02) != 0) event = std::min(event, this->scheduler_.event_cycle(SchedulerEvent::PpuMode)); // STAT
+    if ((enabled & 0x04) != 0) event = std::min(event, this->scheduler_.event_cycle(SchedulerEvent::TimerOverflow));
+    return event;
+}
+
+uint32_t CPU::interpret() {
+    const uint32_t before = this->tstates;
 
-    uint8_t opcode = this->memory_.read_byte(this->registers_.PC);
     if (this->halt_bug_active) {
-        // HALT bug: one instruction executes with opcode fetch but without PC increment.
+        // HALT bug: one instruction executes with opcode fetch but without PC increment,
+        // so its immediate operand starts at the opcode byte itself.
+        const uint8_t opcode = this->memory_.read_byte(this->registers_.PC);
         this->registers_.PC = static_cast<uint16_t>(this->registers_.PC - 1);
         this->halt_bug_active = false;
+        this->imm_ = BlockCache::read_immediate(this->memory_, this->registers_.PC, BlockCache::length(opcode));
+        this->exec(opcode);
+    } else {
+        const MicroOp op = this->fetch();
+        this->imm_ = op.imm;
+        this->exec(op.opcode);
     }
-    this->exec(opcode);
 
     // EI enables IME after the following instruction.
     if (this->ime_enable_delay > 0) {
@@ -50,23 +248,600 @@ uint32_t CPU::step() {
         }
     }
 
-    return static_cast<uint32_t>(this->tstates - before);
+    return this->tstates - before;
+}
+
+void CPU::attach_timer(Timer *timer) { this->timer_ = timer; }
+
+namespace {
+// Addresses whose value only changes on a PPU mode/line change, a timer overflow or a CPU write (which a polling
+// loop does not do, so only an interrupt handler could change them).
+constexpr bool is_idle_pollable(uint16_t address) {
+    if (address == 0xFF0F || address == 0xFF41 || address == 0xFF44) return true; // IF, STAT, LY
+    if (address >= 0xC000 && address <= 0xDFFF) return true;                       // WRAM
+    return address >= 0xFF80 && address <= 0xFFFE;                                   // HRAM
+}
+} // namespace
+
+uint32_t CPU::event_horizon() {
+    return std::min(this->scheduler_.cycles_until_next_event(), config::k_tstates_per_frame);
+}
+
+uint32_t CPU::run_loop_shortcut() {
+    this->peek();
+    if (this->block_cursor_ == nullptr) return 0;
+
+    const Block *block = this->block_;
+    if (block->poll_loop) return this->skip_idle_loop(*block);
+    if (block->bulk_loop != BulkLoop::None) return this->run_bulk_loop(*block);
+    return 0;
+}
+
+uint32_t CPU::skip_idle_loop(const Block &block) {
+    const MicroOp &load = block.ops.front();
+    uint16_t address = load.imm;
+    switch (load.opcode) {
+    case 0x0A:
+        address = this->registers_.get_bc();
+        break;
+    case 0x1A:
+        address = this->registers_.get_de();
+        break;
+    case 0x7E:
+        address = this->registers_.get_hl();
+        break;
+    case 0xF0:
+        address = static_cast<uint16_t>(0xFF00 | (load.imm & 0xFF));
+        break;
+    case 0xF2:
+        address = static_cast<uint16_t>(0xFF00 | this->registers_.C);
+        break;
+    default:
+        break;
+    }
+    if (!is_idle_pollable(address)) return 0;
+
+    // Nothing the loop can observe changes before the next PPU event or TIMA overflow.
+    const uint32_t loop_cycles = block.loop_cycles;
+    const uint32_t iterations = this->event_horizon() / loop_cycles;
+    if (iterations < 2) return 0;
+
+    // The first iteration runs for real to find out whether the loop is taken at all. Without PPU ticks in
+    // between, its load sees the state at the start of the iteration, which is the same as it is within the horizon.
+    const uint16_t start = block.start;
+    uint32_t cycles = 0;
+    for (size_t i = 0; i < block.ops.size(); ++i) {
+        cycles += this->interpret();
+    }
+    if (this->registers_.PC != start) return cycles;
+
+    const uint32_t skipped = (iterations - 1) * loop_cycles;
+    this->tstates += skipped;
+    this->idle_skips_ += 1;
+    this->idle_skipped_cycles_ += skipped;
+    return cycles + skipped;
+}
+
+void CPU::attach_jit(Jit *jit, bool lockstep) {
+    this->jit_ = jit;
+    this->jit_lockstep_ = lockstep;
+
+    JitContext &context = this->jit_context_;
+    context.wram = lockstep ? this->jit_shadow_wram_.data() : this->memory_.wram_data();
+    context.hram = lockstep ? this->jit_shadow_hram_.data() : this->memory_.hram_data();
+    context.code_pages = this->block_cache_.code_page_map();
+    context.flag_table = jit != nullptr ? jit->flag_table() : nullptr;
+    context.read = lockstep ? nullptr : &CPU::jit_read_hook;
+    context.write = lockstep ? nullptr : &CPU::jit_write_hook;
+    context.cpu = this;
+}
+
+namespace {
+// Whether count bytes starting at address (walking up, or down when step is -1) lie inside one region that bulk
+// loops may touch: plain memory up to OAM, or HRAM. IO registers and the unusable area are never accessed in bulk.
+constexpr bool is_bulk_range(uint16_t address, uint32_t count, int step, bool write) {
+    const int32_t last = static_cast<int32_t>(address) + step * static_cast<int32_t>(count - 1);
+    const int32_t low = std::min<int32_t>(address, last);
+    const int32_t high = std::max<int32_t>(address, last);
+    if (low < 0 || high > 0xFFFF) return false;
+    if (low >= 0xFF80 && high <= 0xFFFE) return true;
+    return (write ? low >= 0x8000 : true) && high <= 0xFE9F;
+}
+} // namespace
+
+uint8_t &CPU::counter_register(uint8_t dec_opcode) {
+    switch (dec_opcode) {
+    case 0x05:
+        return this->registers_.B;
+    case 0x0D:
+        return this->registers_.C;
+    case 0x15:
+        return this->registers_.D;
+    default:
+        return this->registers_.E;
+    }
+}
+
+uint32_t CPU::run_bulk_loop(const Block &block) {
+    const MicroOp *body = block.ops.data();
+    const bool fill = block.bulk_loop == BulkLoop::Fill8 || block.bulk_loop == BulkLoop::Fill16;
+    const bool wide = block.bulk_loop == BulkLoop::Fill16 || block.bulk_loop == BulkLoop::Copy16;
+    const uint8_t hl_opcode = block.bulk_loop == BulkLoop::Fill16 ? body[1].opcode : body[0].opcode;
+    const int hl_step = (hl_opcode == 0x22 || hl_opcode == 0x2A) ? 1 : -1;
+
+    uint8_t *counter8 = wide ? nullptr : &this->counter_register(body[block.bulk_loop == BulkLoop::Fill8 ? 1 : 3].opcode);
+    const uint32_t counter = wide ? this->registers_.get_bc() : *counter8;
+    const uint32_t remaining = counter != 0 ? counter : (wide ? 0x10000U : 0x100U);
+
+    // The PPU (and with it VRAM/OAM access) and the timer do not change state within the horizon, so running the
+    // iterations back to back and ticking the components afterwards is indistinguishable from interleaving them.
+    const uint32_t loop_cycles = block.loop_cycles;
+    const uint32_t iterations = std::min(remaining, this->event_horizon() / loop_cycles);
+    if (iterations < 2) return 0;
+
+    uint16_t hl = this->registers_.get_hl();
+    uint16_t de = this->registers_.get_de();
+    if (!is_bulk_range(hl, iterations, hl_step, fill)) return 0;
+    if (!fill && !is_bulk_range(de, iterations, 1, true)) return 0;
+
+    uint8_t value = this->registers_.A;
+    if (block.bulk_loop == BulkLoop::Fill16) value = body[0].opcode == 0x3E ? static_cast<uint8_t>(body[0].imm) : 0;
+    for (uint32_t i = 0; i < iterations; ++i) {
+        if (fill) {
+            this->memory_.write_byte(hl, value);
+        } else {
+            value = this->memory_.read_byte(hl);
+            this->memory_.write_byte(de, value);
+            de = static_cast<uint16_t>(de + 1);
+        }
+        hl = static_cast<uint16_t>(hl + hl_step);
+    }
+    this->registers_.set_hl(hl);
+    this->registers_.set_de(de);
+
+    if (wide) {
+        // DEC BC; LD A, B; OR C
+        const uint16_t bc = static_cast<uint16_t>(counter - iterations);
+        this->registers_.set_bc(bc);
+        this->registers_.A = static_cast<uint8_t>((bc >> 8) | (bc & 0xFF));
+        this->registers_.set_flags(this->registers_.A == 0, false, false, false);
+    } else {
+        // DEC r: H is set when the last decrement borrowed from bit 4. C is left alone.
+        const uint8_t before_last = static_cast<uint8_t>(counter - (iterations - 1));
+        *counter8 = static_cast<uint8_t>(counter - iterations);
+        this->registers_.set_flags(*counter8 == 0, true, (before_last & 0x0F) == 0, this->registers_.get_flag_c());
+        if (!fill) this->registers_.A = value;
+    }
+
+    // The final iteration falls through the branch, which takes 4 T-states less than looping.
+    const bool finished = iterations == remaining;
+    const uint32_t cycles = iterations * loop_cycles - (finished ? 4 : 0);
+    this->registers_.PC = finished ? block.end : block.start;
+    this->block_cursor_ = this->block_end_;
+    this->tstates += cycles;
+    this->bulk_loops_ += 1;
+    this->bulk_loop_cycles_ += cycles;
+    return cycles;
+}
+
+uint32_t CPU::run_jit_block() {
+    const uint16_t pc = this->registers_.PC;
+    const uint16_t bank = this->memory_.rom_bank(pc);
+    const JitBlock *block = this->jit_->lookup(pc, bank);
+    if (block == nullptr) return 0;
+
+    // Blocks do not poll for interrupts, so one only runs if no interrupt that would be taken can be raised
+    // before its longest exit. OAM DMA always falls back to the interpreter.
+    const uint32_t budget = this->scheduler_.cycles_until(this->next_interrupt_event());
+    if (this->ppu_.is_dma_active() || block->max_cycles > budget) return 0;
+
+    if (this->jit_lockstep_) return this->run_jit_lockstep(*block);
+
+    this->load_jit_context();
+    this->jit_synced_ = 0;
+    const uint32_t cycles = block->fn(&this->jit_context_);
+    this->store_jit_context();
+
+    this->jit_->count_native_run();
+    this->tstates += cycles;
+    return cycles - this->jit_synced_;
+}
+
+uint32_t CPU::run_jit_lockstep(const JitBlock &block) {
+    const uint16_t start_pc = this->registers_.PC;
+    std::memcpy(this->jit_shadow_wram_.data(), this->memory_.wram_data(), this->jit_shadow_wram_.size());
+    std::memcpy(this->jit_shadow_hram_.data(), this->memory_.hram_data(), this->jit_shadow_hram_.size());
+
+    this->load_jit_context();
+    const uint32_t expected_cycles = block.fn(&this->jit_context_);
+    if (expected_cycles == 0) return 0; // Side exit on the first instruction
+    this->jit_->count_native_run();
+
+    uint32_t cycles = 0;
+    while (cycles < expected_cycles) {
+        cycles += this->interpret();
+    }
+
+    const JitContext &jit = this->jit_context_;
+    const Registers &interp = this->registers_;
+    const uint16_t jit_af = static_cast<uint16_t>((jit.a << 8) | jit.f);
+    const uint16_t jit_bc = static_cast<uint16_t>((jit.b << 8) | jit.c);
+    const uint16_t jit_de = static_cast<uint16_t>((jit.d << 8) | jit.e);
+    const uint16_t jit_hl = static_cast<uint16_t>((jit.h << 8) | jit.l);
+    const bool registers_match = jit_af == this->registers_.get_af() && jit_bc == interp.get_bc() && jit_de == interp.get_de() &&
+                                 jit_hl == interp.get_hl() && jit.pc == interp.PC && cycles == expected_cycles;
+    const bool memory_match = std::memcmp(this->jit_shadow_wram_.data(), this->memory_.wram_data(), this->jit_shadow_wram_.size()) == 0 &&
+                              std::memcmp(this->jit_shadow_hram_.data(), this->memory_.hram_data(), this->jit_shadow_hram_.size()) == 0;
+    if (!registers_match || !memory_match) {
+        std::ostringstream message;
+        message << std::hex << std::uppercase << std::setfill('0') << "JIT lockstep mismatch in block 0x" << std::setw(4) << start_pc
+                << (memory_match ? "" : " (memory differs)") << ": jit AF=" << std::setw(4) << jit_af << " BC=" << std::setw(4) << jit_bc
+                << " DE=" << std::setw(4) << jit_de << " HL=" << std::setw(4) << jit_hl << " PC=" << std::setw(4) << jit.pc << std::dec
+                << " cycles=" << expected_cycles << std::hex << ", interpreter AF=" << std::setw(4) << this->registers_.get_af()
+                << " BC=" << std::setw(4) << interp.get_bc() << " DE=" << std::setw(4) << interp.get_de() << " HL=" << std::setw(4)
+                << interp.get_hl() << " PC=" << std::setw(4) << interp.PC << std::dec << " cycles=" << cycles;
+        throw std::runtime_error(message.str());
+    }
+    return cycles;
+}
+
+void CPU::load_jit_context() {
+    JitContext &context = this->jit_context_;
+    const uint16_t af = this->registers_.get_af();
+    context.a = static_cast<uint8_t>(af >> 8);
+    context.f = static_cast<uint8_t>(af);
+    context.b = this->registers_.B;
+    context.c = this->registers_.C;
+    context.d = this->registers_.D;
+    context.e = this->registers_.E;
+    context.h = this->registers_.H;
+    context.l = this->registers_.L;
+    context.stop_after_write = 0;
+    context.rom = this->memory_.rom_data();
+    context.rom_limit = static_cast<uint32_t>(std::min<size_t>(this->memory_.rom_size(), 0x8000));
+}
+
+void CPU::store_jit_context() {
+    const JitContext &context = this->jit_context_;
+    this->registers_.set_af(static_cast<uint16_t>((context.a << 8) | context.f));
+    this->registers_.B = context.b;
+    this->registers_.C = context.c;
+    this->registers_.D = context.d;
+    this->registers_.E = context.e;
+    this->registers_.H = context.h;
+    this->registers_.L = context.l;
+    this->registers_.PC = context.pc;
+
+    // The interpreter's block cursor no longer follows PC.
+    this->block_cursor_ = nullptr;
+    this->block_end_ = nullptr;
+}
+
+// Brings the PPU and timer up to the point in the block where the access happens, as the interpreter
+// would have ticked them after each preceding instruction.
+void CPU::jit_sync(uint32_t cycles) {
+    const uint32_t delta = cycles - this->jit_synced_;
+    if (delta == 0) return;
+    this->scheduler_.advance(delta);
+    this->ppu_.catch_up();
+    this->timer_->catch_up();
+    this->jit_synced_ = cycles;
+}
+
+uint8_t CPU::jit_read_hook(JitContext *context, uint16_t address, uint32_t cycles) {
+    CPU &cpu = *context->cpu;
+    cpu.jit_sync(cycles);
+    return cpu.memory_.read_byte(address);
+}
+
+void CPU::jit_write_hook(JitContext *context, uint16_t address, uint8_t value, uint32_t cycles) {
+    CPU &cpu = *context->cpu;
+    cpu.jit_sync(cycles);
+    cpu.memory_.write_byte(address, value);
+    cpu.ppu_.request_catch_up();
+    context->stop_after_write = 1;
+}
+
+MicroOp CPU::peek() {
+    const uint16_t pc = this->registers_.PC;
+    if (this->block_generation_ == this->block_cache_.generation() && this->block_cursor_ != this->block_end_ &&
+        this->block_cursor_->pc == pc) {
+        return *this->block_cursor_;
+    }
+
+    const Block *block = this->block_cache_.lookup(pc);
+    if (block == nullptr) {
+        // Code outside ROM/WRAM/HRAM is decoded in place on every fetch.
+        this->block_cursor_ = nullptr;
+        this->block_end_ = nullptr;
+        return BlockCache::decode(this->memory_, pc);
+    }
+
+    this->block_ = block;
+    this->block_cursor_ = block->ops.data();
+    this->block_end_ = block->ops.data() + block->ops.size();
+    this->block_generation_ = this->block_cache_.generation();
+    return *this->block_cursor_;
+}
+
+MicroOp CPU::fetch() {
+    const MicroOp op = this->peek();
+    if (this->block_cursor_ != this->block_end_) {
+        this->block_cache_.count_executed_op();
+        this->block_cursor_ += 1;
+    }
+    return op;
 }
 
 void CPU::exec(uint8_t opcode) {
-    OpInfo op_info = this->ops[opcode];
-    (this->*op_info.fn)();
+    if constexpr (config::k_table_dispatch) {
+        // Debug fallback: indirect call through the named opcode table.
+        OpInfo op_info = this->ops[opcode];
+        (this->*op_info.fn)();
+    } else {
+        // Dense switch: compiles to a single jump table and lets the compiler inline the handlers.
+        // clang-format off
+        switch (opcode) {
+        case 0x00: this->op_nop(); break;           // NOP
+        case 0x01: this->op_ld_bc_n16(); break;     // LD BC, n16
+        case 0x02: this->op_ld_bcm_a(); break;      // LD [BC], A
+        case 0x03: this->op_inc_bc(); break;        // INC BC
+        case 0x04: this->op_inc_r<0x04>(); break;   // INC B
+        case 0x05: this->op_dec_r<0x05>(); break;   // DEC B
+        case 0x06: this->op_ld_b_n8(); break;       // LD B, n8
+        case 0x07: this->op_rlca(); break;          // RLCA
+        case 0x08: this->op_ld_a16m_sp(); break;    // LD [a16], SP
+        case 0x09: this->op_add_hl_bc(); break;     // ADD HL, BC
+        case 0x0A: this->op_ld_a_bcm(); break;      // LD A, [BC]
+        case 0x0B: this->op_dec_bc(); break;        // DEC BC
+        case 0x0C: this->op_inc_r<0x0C>(); break;   // INC C
+        case 0x0D: this->op_dec_r<0x0D>(); break;   // DEC C
+        case 0x0E: this->op_ld_c_n8(); break;       // LD C, n8
+        case 0x0F: this->op_rrca(); break;          // RRCA
+        case 0x10: this->op_stop_n8(); break;       // STOP n8
+        case 0x11: this->op_ld_de_n16(); break;     // LD DE, n16
+        case 0x12: this->op_ld_dem_a(); break;      // LD [DE], A
+        case 0x13: this->op_inc_de(); break;        // INC DE
+        case 0x14: this->op_inc_r<0x14>(); break;   // INC D
+        case 0x15: this->op_dec_r<0x15>(); break;   // DEC D
+        case 0x16: this->op_ld_d_n8(); break;       // LD D, n8
+        case 0x17: this->op_rla(); break;           // RLA
+        case 0x18: this->op_jr_e8(); break;         // JR e8
+        case 0x19: this->op_add_hl_de(); break;     // ADD HL, DE
+        case 0x1A: this->op_ld_a_dem(); break;      // LD A, [DE]
+        case 0x1B: this->op_dec_de(); break;        // DEC DE
+        case 0x1C: this->op_inc_r<0x1C>(); break;   // INC E
+        case 0x1D: this->op_dec_r<0x1D>(); break;   // DEC E
+        case 0x1E: this->op_ld_e_n8(); break;       // LD E, n8
+        case 0x1F: this->op_rra(); break;           // RRA
+        case 0x20: this->op_jr_nz_e8(); break;      // JR NZ, e8
+        case 0x21: this->op_ld_hl_a16(); break;     // LD HL, n16
+        case 0x22: this->op_ld_hlim_a(); break;     // LD [HL+], A
+        case 0x23: this->op_inc_hl(); break;        // INC HL
+        case 0x24: this->op_inc_r<0x24>(); break;   // INC H
+        case 0x25: this->op_dec_r<0x25>(); break;   // DEC H
+        case 0x26: this->op_ld_h_n8(); break;       // LD H, n8
+        case 0x27: this->op_daa(); break;           // DAA
+        case 0x28: this->op_jr_z_e8(); break;       // JR Z, e8
+        case 0x29: this->op_add_hl_hl(); break;     // ADD HL, HL
+        case 0x2A: this->op_ld_a_hlim(); break;     // LD A, [HL+]
+        case 0x2B: this->op_dec_hl(); break;        // DEC HL
+        case 0x2C: this->op_inc_r<0x2C>(); break;   // INC L
+        case 0x2D: this->op_dec_r<0x2D>(); break;   // DEC L
+        case 0x2E: this->op_ld_l_n8(); break;       // LD L, n8
+        case 0x2F: this->op_cpl(); break;           // CPL
+        case 0x30: this->op_jr_nc_e8(); break;      // JR NC, e8
+        case 0x31: this->op_ld_sp_a16(); break;     // LD SP, n16
+        case 0x32: this->op_ld_hldm_a(); break;     // LD [HL-], A
+        case 0x33: this->op_inc_sp(); break;        // INC SP
+        case 0x34: this->op_inc_r<0x34>(); break;   // INC [HL]
+        case 0x35: this->op_dec_r<0x35>(); break;   // DEC [HL]
+        case 0x36: this->op_ld_hlm_n8(); break;     // LD [HL], n8
+        case 0x37: this->op_scf(); break;           // SCF
+        case 0x38: this->op_jr_c_e8(); break;       // JR C, e8
+        case 0x39: this->op_add_hl_sp(); break;     // ADD HL, SP
+        case 0x3A: this->op_ld_a_hldm(); break;     // LD A, [HL-]
+        case 0x3B: this->op_dec_sp(); break;        // DEC SP
+        case 0x3C: this->op_inc_r<0x3C>(); break;   // INC A
+        case 0x3D: this->op_dec_r<0x3D>(); break;   // DEC A
+        case 0x3E: this->op_ld_a_n8(); break;       // LD A, n8
+        case 0x3F: this->op_ccf(); break;           // CCF
+        case 0x40: this->op_ld_r_r<0x40>(); break;  // LD B, B
+        case 0x41: this->op_ld_r_r<0x41>(); break;  // LD B, C
+        case 0x42: this->op_ld_r_r<0x42>(); break;  // LD B, D
+        case 0x43: this->op_ld_r_r<0x43>(); break;  // LD B, E
+        case 0x44: this->op_ld_r_r<0x44>(); break;  // LD B, H
+        case 0x45: this->op_ld_r_r<0x45>(); break;  // LD B, L
+        case 0x46: this->op_ld_r_r<0x46>(); break;  // LD B, [HL]
+        case 0x47: this->op_ld_r_r<0x47>(); break;  // LD B, A
+        case 0x48: this->op_ld_r_r<0x48>(); break;  // LD C, B
+        case 0x49: this->op_ld_r_r<0x49>(); break;  // LD C, C
+        case 0x4A: this->op_ld_r_r<0x4A>(); break;  // LD C, D
+        case 0x4B: this->op_ld_r_r<0x4B>(); break;  // LD C, E
+        case 0x4C: this->op_ld_r_r<0x4C>(); break;  // LD C, H
+        case 0x4D: this->op_ld_r_r<0x4D>(); break;  // LD C, L
+        case 0x4E: this->op_ld_r_r<0x4E>(); break;  // LD C, [HL]
+        case 0x4F: this->op_ld_r_r<0x4F>(); break;  // LD C, A
+        case 0x50: this->op_ld_r_r<0x50>(); break;  // LD D, B
+        case 0x51: this->op_ld_r_r<0x51>(); break;  // LD D, C
+        case 0x52: this->op_ld_r_r<0x52>(); break;  // LD D, D
+        case 0x53: this->op_ld_r_r<0x53>(); break;  // LD D, E
+        case 0x54: this->op_ld_r_r<0x54>(); break;  // LD D, H
+        case 0x55: this->op_ld_r_r<0x55>(); break;  // LD D, L
+        case 0x56: this->op_ld_r_r<0x56>(); break;  // LD D, [HL]
+        case 0x57: this->op_ld_r_r<0x57>(); break;  // LD D, A
+        case 0x58: this->op_ld_r_r<0x58>(); break;  // LD E, B
+        case 0x59: this->op_ld_r_r<0x59>(); break;  // LD E, C
+        case 0x5A: this->op_ld_r_r<0x5A>(); break;  // LD E, D
+        case 0x5B: this->op_ld_r_r<0x5B>(); break;  // LD E, E
+        case 0x5C: this->op_ld_r_r<0x5C>(); break;  // LD E, H
+        case 0x5D: this->op_ld_r_r<0x5D>(); break;  // LD E, L
+        case 0x5E: this->op_ld_r_r<0x5E>(); break;  // LD E, [HL]
+        case 0x5F: this->op_ld_r_r<0x5F>(); break;  // LD E, A
+        case 0x60: this->op_ld_r_r<0x60>(); break;  // LD H, B
+        case 0x61: this->op_ld_r_r<0x61>(); break;  // LD H, C
+        case 0x62: this->op_ld_r_r<0x62>(); break;  // LD H, D
+        case 0x63: this->op_ld_r_r<0x63>(); break;  // LD H, E
+        case 0x64: this->op_ld_r_r<0x64>(); break;  // LD H, H
+        case 0x65: this->op_ld_r_r<0x65>(); break;  // LD H, L
+        case 0x66: this->op_ld_r_r<0x66>(); break;  // LD H, [HL]
+        case 0x67: this->op_ld_r_r<0x67>(); break;  // LD H, A
+        case 0x68: this->op_ld_r_r<0x68>(); break;  // LD L, B
+        case 0x69: this->op_ld_r_r<0x69>(); break;  // LD L, C
+        case 0x6A: this->op_ld_r_r<0x6A>(); break;  // LD L, D
+        case 0x6B: this->op_ld_r_r<0x6B>(); break;  // LD L, E
+        case 0x6C: this->op_ld_r_r<0x6C>(); break;  // LD L, H
+        case 0x6D: this->op_ld_r_r<0x6D>(); break;  // LD L, L
+        case 0x6E: this->op_ld_r_r<0x6E>(); break;  // LD L, [HL]
+        case 0x6F: this->op_ld_r_r<0x6F>(); break;  // LD L, A
+        case 0x70: this->op_ld_r_r<0x70>(); break;  // LD [HL], B
+        case 0x71: this->op_ld_r_r<0x71>(); break;  // LD [HL], C
+        case 0x72: this->op_ld_r_r<0x72>(); break;  // LD [HL], D
+        case 0x73: this->op_ld_r_r<0x73>(); break;  // LD [HL], E
+        case 0x74: this->op_ld_r_r<0x74>(); break;  // LD [HL], H
+        case 0x75: this->op_ld_r_r<0x75>(); break;  // LD [HL], L
+        case 0x76: this->op_halt(); break;          // HALT
+        case 0x77: this->op_ld_r_r<0x77>(); break;  // LD [HL], A
+        case 0x78: this->op_ld_r_r<0x78>(); break;  // LD A, B
+        case 0x79: this->op_ld_r_r<0x79>(); break;  // LD A, C
+        case 0x7A: this->op_ld_r_r<0x7A>(); break;  // LD A, D
+        case 0x7B: this->op_ld_r_r<0x7B>(); break;  // LD A, E
+        case 0x7C: this->op_ld_r_r<0x7C>(); break;  // LD A, H
+        case 0x7D: this->op_ld_r_r<0x7D>(); break;  // LD A, L
+        case 0x7E: this->op_ld_r_r<0x7E>(); break;  // LD A, [HL]
+        case 0x7F: this->op_ld_r_r<0x7F>(); break;  // LD A, A
+        case 0x80: this->op_alu_a_r<0x80>(); break; // ADD A, B
+        case 0x81: this->op_alu_a_r<0x81>(); break; // ADD A, C
+        case 0x82: this->op_alu_a_r<0x82>(); break; // ADD A, D
+        case 0x83: this->op_alu_a_r<0x83>(); break; // ADD A, E
+        case 0x84: this->op_alu_a_r<0x84>(); break; // ADD A, H
+        case 0x85: this->op_alu_a_r<0x85>(); break; // ADD A, L
+        case 0x86: this->op_alu_a_r<0x86>(); break; // ADD A, [HL]
+        case 0x87: this->op_alu_a_r<0x87>(); break; // ADD A, A
+        case 0x88: this->op_alu_a_r<0x88>(); break; // ADC A, B
+        case 0x89: this->op_alu_a_r<0x89>(); break; // ADC A, C
+        case 0x8A: this->op_alu_a_r<0x8A>(); break; // ADC A, D
+        case 0x8B: this->op_alu_a_r<0x8B>(); break; // ADC A, E
+        case 0x8C: this->op_alu_a_r<0x8C>(); break; // ADC A, H
+        case 0x8D: this->op_alu_a_r<0x8D>(); break; // ADC A, L
+        case 0x8E: this->op_alu_a_r<0x8E>(); break; // ADC A, [HL]
+        case 0x8F: this->op_alu_a_r<0x8F>(); break; // ADC A, A
+        case 0x90: this->op_alu_a_r<0x90>(); break; // SUB A, B
+        case 0x91: this->op_alu_a_r<0x91>(); break; // SUB A, C
+        case 0x92: this->op_alu_a_r<0x92>(); break; // SUB A, D
+        case 0x93: this->op_alu_a_r<0x93>(); break; // SUB A, E
+        case 0x94: this->op_alu_a_r<0x94>(); break; // SUB A, H
+        case 0x95: this->op_alu_a_r<0x95>(); break; // SUB A, L
+        case 0x96: this->op_alu_a_r<0x96>(); break; // SUB A, [HL]
+        case 0x97: this->op_alu_a_r<0x97>(); break; // SUB A, A
+        case 0x98: this->op_alu_a_r<0x98>(); break; // SBC A, B
+        case 0x99: this->op_alu_a_r<0x99>(); break; // SBC A, C
+        case 0x9A: this->op_alu_a_r<0x9A>(); break; // SBC A, D
+        case 0x9B: this->op_alu_a_r<0x9B>(); break; // SBC A, E
+        case 0x9C: this->op_alu_a_r<0x9C>(); break; // SBC A, H
+        case 0x9D: this->op_alu_a_r<0x9D>(); break; // SBC A, L
+        case 0x9E: this->op_alu_a_r<0x9E>(); break; // SBC A, [HL]
+        case 0x9F: this->op_alu_a_r<0x9F>(); break; // SBC A, A
+        case 0xA0: this->op_alu_a_r<0xA0>(); break; // AND A, B
+        case 0xA1: this->op_alu_a_r<0xA1>(); break; // AND A, C
+        case 0xA2: this->op_alu_a_r<0xA2>(); break; // AND A, D
+        case 0xA3: this->op_alu_a_r<0xA3>(); break; // AND A, E
+        case 0xA4: this->op_alu_a_r<0xA4>(); break; // AND A, H
+        case 0xA5: this->op_alu_a_r<0xA5>(); break; // AND A, L
+        case 0xA6: this->op_alu_a_r<0xA6>(); break; // AND A, [HL]
+        case 0xA7: this->op_alu_a_r<0xA7>(); break; // AND A, A
+        case 0xA8: this->op_alu_a_r<0xA8>(); break; // XOR A, B
+        case 0xA9: this->op_alu_a_r<0xA9>(); break; // XOR A, C
+        case 0xAA: this->op_alu_a_r<0xAA>(); break; // XOR A, D
+        case 0xAB: this->op_alu_a_r<0xAB>(); break; // XOR A, E
+        case 0xAC: this->op_alu_a_r<0xAC>(); break; // XOR A, H
+        case 0xAD: this->op_alu_a_r<0xAD>(); break; // XOR A, L
+        case 0xAE: this->op_alu_a_r<0xAE>(); break; // XOR A, [HL]
+        case 0xAF: this->op_alu_a_r<0xAF>(); break; // XOR A, A
+        case 0xB0: this->op_alu_a_r<0xB0>(); break; // OR A, B
+        case 0xB1: this->op_alu_a_r<0xB1>(); break; // OR A, C
+        case 0xB2: this->op_alu_a_r<0xB2>(); break; // OR A, D
+        case 0xB3: this->op_alu_a_r<0xB3>(); break; // OR A, E
+        case 0xB4: this->op_alu_a_r<0xB4>(); break; // OR A, H
+        case 0xB5: this->op_alu_a_r<0xB5>(); break; // OR A, L
+        case 0xB6: this->op_alu_a_r<0xB6>(); break; // OR A, [HL]
+        case 0xB7: this->op_alu_a_r<0xB7>(); break; // OR A, A
+        case 0xB8: this->op_alu_a_r<0xB8>(); break; // CP A, B
+        case 0xB9: this->op_alu_a_r<0xB9>(); break; // CP A, C
+        case 0xBA: this->op_alu_a_r<0xBA>(); break; // CP A, D
+        case 0xBB: this->op_alu_a_r<0xBB>(); break; // CP A, E
+        case 0xBC: this->op_alu_a_r<0xBC>(); break; // CP A, H
+        case 0xBD: this->op_alu_a_r<0xBD>(); break; // CP A, L
+        case 0xBE: this->op_alu_a_r<0xBE>(); break; // CP A, [HL]
+        case 0xBF: this->op_alu_a_r<0xBF>(); break; // CP A, A
+        case 0xC0: this->op_ret_nz(); break;        // RET NZ
+        case 0xC1: this->op_pop_rr<0xC1>(); break;  // POP BC
+        case 0xC2: this->op_jp_nz_a16(); break;     // JP NZ, a16
+        case 0xC3: this->op_jp_a16(); break;        // JP a16
+        case 0xC4: this->op_call_nz_a16(); break;   // CALL NZ, a16
+        case 0xC5: this->op_push_rr<0xC5>(); break; // PUSH BC
+        case 0xC6: this->op_add_a_n8(); break;      // ADD A, n8
+        case 0xC7: this->op_rst_00(); break;        // RST $00
+        case 0xC8: this->op_ret_z(); break;         // RET Z
+        case 0xC9: this->op_ret(); break;           // RET
+        case 0xCA: this->op_jp_z_a16(); break;      // JP Z, a16
+        case 0xCB: this->op_prefix(); break;        // PREFIX
+        case 0xCC: this->op_call_z_a16(); break;    // CALL Z, a16
+        case 0xCD: this->op_call_a16(); break;      // CALL a16
+        case 0xCE: this->op_adc_a_n8(); break;      // ADC A, n8
+        case 0xCF: this->op_rst_08(); break;        // RST $08
+        case 0xD0: this->op_ret_nc(); break;        // RET NC
+        case 0xD1: this->op_pop_rr<0xD1>(); break;  // POP DE
+        case 0xD2: this->op_jp_nc_a16(); break;     // JP NC, a16
+        case 0xD4: this->op_call_nc_a16(); break;   // CALL NC, a16
+        case 0xD5: this->op_push_rr<0xD5>(); break; // PUSH DE
+        case 0xD6: this->op_sub_a_n8(); break;      // SUB A, n8
+        case 0xD7: this->op_rst_10(); break;        // RST $10
+        case 0xD8: this->op_ret_c(); break;         // RET C
+        case 0xD9: this->op_reti(); break;          // RETI
+        case 0xDA: this->op_jp_c_a16(); break;      // JP C, a16
+        case 0xDC: this->op_call_c_a16(); break;    // CALL C, a16
+        case 0xDE: this->op_sbc_a_n8(); break;      // SBC A, n8
+        case 0xDF: this->op_rst_18(); break;        // RST $18
+        case 0xE0: this->op_ldh_a8m_a(); break;     // LDH [a8], A
+        case 0xE1: this->op_pop_rr<0xE1>(); break;  // POP HL
+        case 0xE2: this->op_ldh_cm_a(); break;      // LDH [C], A
+        case 0xE5: this->op_push_rr<0xE5>(); break; // PUSH HL
+        case 0xE6: this->op_and_a_n8(); break;      // AND A, n8
+        case 0xE7: this->op_rst_20(); break;        // RST $20
+        case 0xE8: this->op_add_sp_e8(); break;     // ADD SP, e8
+        case 0xE9: this->op_jp_hl(); break;         // JP HL
+        case 0xEA: this->op_ld_a16m_a(); break;     // LD [a16], A
+        case 0xEE: this->op_xor_a_n8(); break;      // XOR A, n8
+        case 0xEF: this->op_rst_28(); break;        // RST $28
+        case 0xF0: this->op_ldh_a_a8m(); break;     // LDH A, [a8]
+        case 0xF1: this->op_pop_rr<0xF1>(); break;  // POP AF
+        case 0xF2: this->op_ldh_a_cm(); break;      // LDH A, [C]
+        case 0xF3: this->op_di(); break;            // DI
+        case 0xF5: this->op_push_rr<0xF5>(); break; // PUSH AF
+        case 0xF6: this->op_or_a_n8(); break;       // OR A, n8
+        case 0xF7: this->op_rst_30(); break;        // RST $30
+        case 0xF8: this->op_ld_hl_sp_e8(); break;   // LD HL, SP+e8
+        case 0xF9: this->op_ld_sp_hl(); break;      // LD SP, HL
+        case 0xFA: this->op_ld_a_a16m(); break;     // LD A, [a16]
+        case 0xFB: this->op_ei(); break;            // EI
+        case 0xFE: this->op_cp_a_n8(); break;       // CP A, n8
+        case 0xFF: this->op_rst_38(); break;        // RST $38
+        default:   this->op_unimplemented(); break;
+        }
+        // clang-format on
+    }
 }
 
-void CPU::service_interrupts() {
+uint32_t CPU::service_interrupts() {
     const uint8_t IE = this->memory_.get_ie();
     const uint8_t IF = this->memory_.get_if();
 
-    if ((IE & IF) == 0) return;
+    if ((IE & IF) == 0) return 0;
     this->halted = false;
     this->stopped = false;
 
-    if (!this->registers_.IME) return;
+    if (!this->registers_.IME) return 0;
     this->registers_.IME = false;
 
     auto service = [&](uint8_t bit, uint16_t vector) -> bool {
@@ -75,16 +850,16 @@ void CPU::service_interrupts() {
 
         this->stack_.push_word(this->registers_.PC);
         this->registers_.PC = vector;
-
-        this->tstates += 20;
         return true;
     };
 
-    if (service(0, 0x0040)) return; // VBlank
-    if (service(1, 0x0048)) return; // STAT
-    if (service(2, 0x0050)) return; // Timer
-    if (service(3, 0x0058)) return; // Serial
-    if (service(4, 0x0060)) return; // Joypad
+    // Dispatch takes 5 M-cycles, during which the PPU and timer keep running.
+    if (service(0, 0x0040)) return 20; // VBlank
+    if (service(1, 0x0048)) return 20; // STAT
+    if (service(2, 0x0050)) return 20; // Timer
+    if (service(3, 0x0058)) return 20; // Serial
+    if (service(4, 0x0060)) return 20; // Joypad
+    return 0;
 };
 
 // default unimplemented opcode handler =======
@@ -104,6 +879,141 @@ void CPU::op_unimplemented() {
 
 // Return time taken to complete in T-states
 
+// templated opcode blocks ====================
+
+// The regular blocks decode their operands from the opcode bits at compile time.
+// r8 index (bits 0-2 / 3-5): 0:B 1:C 2:D 3:E 4:H 5:L 6:[HL] 7:A
+// r16 index (bits 4-5):      0:BC 1:DE 2:HL 3:AF (PUSH/POP only)
+
+template <uint8_t Index> uint8_t &CPU::r8() {
+    static_assert(Index < 8 && Index != 6, "[HL] is not a register operand");
+    if constexpr (Index == 0) return this->registers_.B;
+    if constexpr (Index == 1) return this->registers_.C;
+    if constexpr (Index == 2) return this->registers_.D;
+    if constexpr (Index == 3) return this->registers_.E;
+    if constexpr (Index == 4) return this->registers_.H;
+    if constexpr (Index == 5) return this->registers_.L;
+    if constexpr (Index == 7) return this->registers_.A;
+}
+
+template <uint8_t Index> uint8_t CPU::read_r8() {
+    if constexpr (Index == 6) {
+        return this->memory_.read_byte(this->registers_.get_hl());
+    } else {
+        return this->r8<Index>();
+    }
+}
+
+template <uint8_t Index> void CPU::write_r8(uint8_t value) {
+    if constexpr (Index == 6) {
+        this->memory_.write_byte(this->registers_.get_hl(), value);
+    } else {
+        this->r8<Index>() = value;
+    }
+}
+
+// 0x04 - 0x3c (step 0x08)
+// INC r
+// 1 4 ([HL]: 1 12)
+// Z 0 H -
+template <uint8_t Opcode> void CPU::op_inc_r() {
+    constexpr uint8_t target = (Opcode >> 3) & 0x07;
+    if constexpr (target == 6) {
+        this->idu_.increment_mem8(this->registers_.get_hl());
+    } else {
+        this->idu_.increment_r8(this->r8<target>());
+    }
+
+    this->registers_.PC += 1;
+    this->tstates += target == 6 ? 12 : 4;
+}
+
+// 0x05 - 0x3d (step 0x08)
+// DEC r
+// 1 4 ([HL]: 1 12)
+// Z 1 H -
+template <uint8_t Opcode> void CPU::op_dec_r() {
+    constexpr uint8_t target = (Opcode >> 3) & 0x07;
+    if constexpr (target == 6) {
+        this->idu_.decrement_mem8(this->registers_.get_hl());
+    } else {
+        this->idu_.decrement_r8(this->r8<target>());
+    }
+
+    this->registers_.PC += 1;
+    this->tstates += target == 6 ? 12 : 4;
+}
+
+// 0x40 - 0x7f (except 0x76 HALT)
+// LD r, r'
+// 1 4 ([HL]: 1 8)
+// - - - -
+template <uint8_t Opcode> void CPU::op_ld_r_r() {
+    constexpr uint8_t target = (Opcode >> 3) & 0x07;
+    constexpr uint8_t source = Opcode & 0x07;
+    static_assert(target != 6 || source != 6, "0x76 is HALT");
+
+    this->write_r8<target>(this->read_r8<source>());
+
+    this->registers_.PC += 1;
+    this->tstates += (target == 6 || source == 6) ? 8 : 4;
+}
+
+// 0x80 - 0xbf
+// ADD/ADC/SUB/SBC/AND/XOR/OR/CP A, r
+// 1 4 ([HL]: 1 8)
+// Flags as per ALU operation
+template <uint8_t Opcode> void CPU::op_alu_a_r() {
+    constexpr uint8_t operation = (Opcode >> 3) & 0x07;
+    constexpr uint8_t source = Opcode & 0x07;
+    const uint8_t value = this->read_r8<source>();
+
+    if constexpr (operation == 0) this->alu_.add_u8(value);
+    if constexpr (operation == 1) this->alu_.adc_u8(value);
+    if constexpr (operation == 2) this->alu_.sub_u8(value);
+    if constexpr (operation == 3) this->alu_.sbc_u8(value);
+    if constexpr (operation == 4) this->alu_.and_u8(value);
+    if constexpr (operation == 5) this->alu_.xor_u8(value);
+    if constexpr (operation == 6) this->alu_.or_u8(value);
+    if constexpr (operation == 7) this->alu_.cp_u8(value);
+
+    this->registers_.PC += 1;
+    this->tstates += source == 6 ? 8 : 4;
+}
+
+// 0xc1 - 0xf1 (step 0x10)
+// POP rr
+// 1 12
+// - - - - (POP AF: Z N H C)
+template <uint8_t Opcode> void CPU::op_pop_rr() {
+    constexpr uint8_t pair = (Opcode >> 4) & 0x03;
+    const uint16_t word = this->stack_.pop_word();
+
+    if constexpr (pair == 0) this->registers_.set_bc(word);
+    if constexpr (pair == 1) this->registers_.set_de(word);
+    if constexpr (pair == 2) this->registers_.set_hl(word);
+    if constexpr (pair == 3) this->registers_.set_af(word);
+
+    this->registers_.PC += 1;
+    this->tstates += 12;
+}
+
+// 0xc5 - 0xf5 (step 0x10)
+// PUSH rr
+// 1 16
+// - - - -
+template <uint8_t Opcode> void CPU::op_push_rr() {
+    constexpr uint8_t pair = (Opcode >> 4) & 0x03;
+
+    if constexpr (pair == 0) this->stack_.push_word(this->registers_.get_bc());
+    if constexpr (pair == 1) this->stack_.push_word(this->registers_.get_de());
+    if constexpr (pair == 2) this->stack_.push_word(this->registers_.get_hl());
+    if constexpr (pair == 3) this->stack_.push_word(this->registers_.get_af());
+
+    this->registers_.PC += 1;
+    this->tstates += 16;
+}
+
 // 0x00
 // NOP
 // 1 4
@@ -118,7 +1028,7 @@ void CPU::op_nop() {
 // 3 12
 // - - - -
 void CPU::op_ld_bc_n16() {
-    uint16_t n16 = this->memory_.read_word(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint16_t n16 = this->imm16();
     this->registers_.set_bc(n16);
 
     this->registers_.PC += 3;
@@ -147,34 +1057,12 @@ void CPU::op_inc_bc() {
     this->tstates += 8;
 }
 
-// 0x04
-// INC B
-// 1 4
-// Z 0 H -
-void CPU::op_inc_b() {
-    this->idu_.increment_r8(this->registers_.B);
-
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x05
-// DEC B
-// 1 4
-// Z 1 H -
-void CPU::op_dec_b() {
-    this->idu_.decrement_r8(this->registers_.B);
-
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
 // 0x06
 // LD B, n8
 // 2 8
 // - - - -
 void CPU::op_ld_b_n8() {
-    uint8_t n8 = this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint8_t n8 = this->imm8();
     this->registers_.B = n8;
 
     this->registers_.PC += 2;
@@ -197,7 +1085,7 @@ void CPU::op_rlca() {
 // 3 20
 // - - - -
 void CPU::op_ld_a16m_sp() {
-    uint16_t a16 = this->memory_.read_word(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint16_t a16 = this->imm16();
     this->memory_.write_word(a16, this->registers_.SP);
 
     this->registers_.PC += 3;
@@ -237,34 +1125,12 @@ void CPU::op_dec_bc() {
     this->tstates += 8;
 }
 
-// 0x0c
-// INC C
-// 1 4
-// Z 0 H -
-void CPU::op_inc_c() {
-    this->idu_.increment_r8(this->registers_.C);
-
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x0d
-// DEC C
-// 1 4
-// Z 1 H -
-void CPU::op_dec_c() {
-    this->idu_.decrement_r8(this->registers_.C);
-
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
 // 0x0e
 // LD C, n8
 // 2 8
 // - - - -
 void CPU::op_ld_c_n8() {
-    uint8_t n8 = this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint8_t n8 = this->imm8();
     this->registers_.C = n8;
 
     this->registers_.PC += 2;
@@ -299,7 +1165,7 @@ void CPU::op_stop_n8() {
 // 3 12
 // - - - -
 void CPU::op_ld_de_n16() {
-    uint16_t n16 = this->memory_.read_word(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint16_t n16 = this->imm16();
     this->registers_.set_de(n16);
 
     this->registers_.PC += 3;
@@ -328,34 +1194,12 @@ void CPU::op_inc_de() {
     this->tstates += 8;
 }
 
-// 0x14
-// INC D
-// 1 4
-// Z 0 H -
-void CPU::op_inc_d() {
-    this->idu_.increment_r8(this->registers_.D);
-
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x15
-// DEC D
-// 1 4
-// Z 1 H -
-void CPU::op_dec_d() {
-    this->idu_.decrement_r8(this->registers_.D);
-
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
 // 0x16
 // LD D, n8
 // 2 8
 // - - - -
 void CPU::op_ld_d_n8() {
-    uint8_t n8 = this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint8_t n8 = this->imm8();
     this->registers_.D = n8;
 
     this->registers_.PC += 2;
@@ -378,7 +1222,7 @@ void CPU::op_rla() {
 // 2 12
 // - - - -
 void CPU::op_jr_e8() {
-    int8_t offset = static_cast<int8_t>(this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1)));
+    int8_t offset = static_cast<int8_t>(this->imm8());
     this->registers_.PC += static_cast<uint16_t>(2 + offset);
     this->tstates += 12;
 }
@@ -416,34 +1260,12 @@ void CPU::op_dec_de() {
     this->tstates += 8;
 }
 
-// 0x1c
-// INC E
-// 1 4
-// Z 0 H -
-void CPU::op_inc_e() {
-    this->idu_.increment_r8(this->registers_.E);
-
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x1d
-// DEC E
-// 1 4
-// Z 1 H -
-void CPU::op_dec_e() {
-    this->idu_.decrement_r8(this->registers_.E);
-
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
 // 0x1e
 // LD E, n8
 // 2 8
 // - - - -
 void CPU::op_ld_e_n8() {
-    uint8_t n8 = this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint8_t n8 = this->imm8();
     this->registers_.E = n8;
 
     this->registers_.PC += 2;
@@ -467,7 +1289,7 @@ void CPU::op_rra() {
 // - - - -
 void CPU::op_jr_nz_e8() {
     if (!this->registers_.get_flag_z()) {
-        int8_t offset = static_cast<int8_t>(this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1)));
+        int8_t offset = static_cast<int8_t>(this->imm8());
         this->registers_.PC += static_cast<uint16_t>(2 + offset);
         this->tstates += 12;
         return;
@@ -481,7 +1303,7 @@ void CPU::op_jr_nz_e8() {
 // 3 12
 // - - - -
 void CPU::op_ld_hl_a16() {
-    uint16_t n16 = this->memory_.read_word(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint16_t n16 = this->imm16();
     this->registers_.set_hl(n16);
 
     this->registers_.PC += 3;
@@ -511,34 +1333,12 @@ void CPU::op_inc_hl() {
     this->tstates += 8;
 }
 
-// 0x24
-// INC H
-// 1 4
-// Z 0 H -
-void CPU::op_inc_h() {
-    this->idu_.increment_r8(this->registers_.H);
-
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x25
-// DEC H
-// 1 4
-// Z 1 H -
-void CPU::op_dec_h() {
-    this->idu_.decrement_r8(this->registers_.H);
-
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
 // 0x26
 // LD H, n8
 // 2 8
 // - - - -
 void CPU::op_ld_h_n8() {
-    uint8_t n8 = this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint8_t n8 = this->imm8();
     this->registers_.H = n8;
 
     this->registers_.PC += 2;
@@ -572,10 +1372,7 @@ void CPU::op_daa() {
     }
 
     this->registers_.A = a;
-    this->registers_.set_flag_z(a == 0);
-    this->registers_.set_flag_n(subtract);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(carry);
+    this->registers_.set_flags(a == 0, subtract, false, carry);
 
     this->registers_.PC += 1;
     this->tstates += 4;
@@ -587,7 +1384,7 @@ void CPU::op_daa() {
 // - - - -
 void CPU::op_jr_z_e8() {
     if (this->registers_.get_flag_z()) {
-        int8_t offset = static_cast<int8_t>(this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1)));
+        int8_t offset = static_cast<int8_t>(this->imm8());
         this->registers_.PC += static_cast<uint16_t>(2 + offset);
         this->tstates += 12;
         return;
@@ -629,32 +1426,12 @@ void CPU::op_dec_hl() {
     this->tstates += 8;
 }
 
-// 0x2c
-// INC L
-// 1 4
-// Z 0 H -
-void CPU::op_inc_l() {
-    this->idu_.increment_r8(this->registers_.L);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x2d
-// DEC L
-// 1 4
-// Z 1 H -
-void CPU::op_dec_l() {
-    this->idu_.decrement_r8(this->registers_.L);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
 // 0x2e
 // LD L, n8
 // 2 8
 // - - - -
 void CPU::op_ld_l_n8() {
-    uint8_t n8 = this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint8_t n8 = this->imm8();
     this->registers_.L = n8;
     this->registers_.PC += 2;
     this->tstates += 8;
@@ -681,7 +1458,7 @@ void CPU::op_cpl() {
 // - - - -
 void CPU::op_jr_nc_e8() {
     if (!this->registers_.get_flag_c()) {
-        int8_t offset = static_cast<int8_t>(this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1)));
+        int8_t offset = static_cast<int8_t>(this->imm8());
         this->registers_.PC += static_cast<uint16_t>(2 + offset);
         this->tstates += 12;
         return;
@@ -695,7 +1472,7 @@ void CPU::op_jr_nc_e8() {
 // 3 12
 // - - - -
 void CPU::op_ld_sp_a16() {
-    uint16_t n16 = this->memory_.read_word(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint16_t n16 = this->imm16();
     this->registers_.SP = n16;
     this->registers_.PC += 3;
     this->tstates += 12;
@@ -722,32 +1499,12 @@ void CPU::op_inc_sp() {
     this->tstates += 8;
 }
 
-// 0x34
-// INC [HL]
-// 1 12
-// Z 0 H -
-void CPU::op_inc_hlm() {
-    this->idu_.increment_mem8(this->registers_.get_hl());
-    this->registers_.PC += 1;
-    this->tstates += 12;
-}
-
-// 0x35
-// DEC [HL]
-// 1 12
-// Z 1 H -
-void CPU::op_dec_hlm() {
-    this->idu_.decrement_mem8(this->registers_.get_hl());
-    this->registers_.PC += 1;
-    this->tstates += 12;
-}
-
 // 0x36
 // LD [HL], n8
 // 2 12
 // - - - -
 void CPU::op_ld_hlm_n8() {
-    uint8_t n8 = this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint8_t n8 = this->imm8();
     this->memory_.write_byte(this->registers_.get_hl(), n8);
     this->registers_.PC += 2;
     this->tstates += 12;
@@ -771,7 +1528,7 @@ void CPU::op_scf() {
 // - - - -
 void CPU::op_jr_c_e8() {
     if (this->registers_.get_flag_c()) {
-        int8_t offset = static_cast<int8_t>(this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1)));
+        int8_t offset = static_cast<int8_t>(this->imm8());
         this->registers_.PC += static_cast<uint16_t>(2 + offset);
         this->tstates += 12;
         return;
@@ -811,32 +1568,12 @@ void CPU::op_dec_sp() {
     this->tstates += 8;
 }
 
-// 0x3c
-// INC A
-// 1 4
-// Z 0 H -
-void CPU::op_inc_a() {
-    this->idu_.increment_r8(this->registers_.A);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x3d
-// DEC A
-// 1 4
-// Z 1 H -
-void CPU::op_dec_a() {
-    this->idu_.decrement_r8(this->registers_.A);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
 // 0x3e
 // LD A, n8
 // 2 8
 // - - - -
 void CPU::op_ld_a_n8() {
-    uint8_t n8 = this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint8_t n8 = this->imm8();
     this->registers_.A = n8;
     this->registers_.PC += 2;
     this->tstates += 8;
@@ -854,1355 +1591,62 @@ void CPU::op_ccf() {
     this->tstates += 4;
 }
 
-// 0x40
-// LD B, B
+// 0x76
+// HALT
 // 1 4
 // - - - -
-void CPU::op_ld_b_b() {
-    this->registers_.B = this->registers_.B;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
+void CPU::op_halt() {
+    const uint8_t pending = static_cast<uint8_t>(this->memory_.get_ie() & this->memory_.get_if() & 0x1F);
 
-// 0x41
-// LD B, C
-// 1 4
-// - - - -
-void CPU::op_ld_b_c() {
-    this->registers_.B = this->registers_.C;
+    // HALT bug case: IME=0 and an interrupt is pending.
+    // CPU does not actually enter halted state.
+    if (this->registers_.IME == false && pending != 0) {
+        this->halt_bug_active = true;
+    } else {
+        this->halted = true;
+    }
     this->registers_.PC += 1;
     this->tstates += 4;
 }
 
-// 0x42
-// LD B, D
-// 1 4
+// 0xc0
+// RET NZ
+// 1 20/8
 // - - - -
-void CPU::op_ld_b_d() {
-    this->registers_.B = this->registers_.D;
+void CPU::op_ret_nz() {
+    if (!this->registers_.get_flag_z()) {
+        uint16_t address = this->stack_.pop_word();
+        this->registers_.PC = address;
+        this->tstates += 20;
+        return;
+    }
     this->registers_.PC += 1;
-    this->tstates += 4;
+    this->tstates += 8;
 }
 
-// 0x43
-// LD B, E
-// 1 4
+// 0xc2
+// JP NZ, a16
+// 3 16/12
 // - - - -
-void CPU::op_ld_b_e() {
-    this->registers_.B = this->registers_.E;
-    this->registers_.PC += 1;
-    this->tstates += 4;
+void CPU::op_jp_nz_a16() {
+    uint16_t address = this->imm16();
+    if (!this->registers_.get_flag_z()) {
+        this->registers_.PC = address;
+        this->tstates += 16;
+        return;
+    }
+    this->registers_.PC += 3;
+    this->tstates += 12;
 }
 
-// 0x44
-// LD B, H
-// 1 4
+// 0xc3
+// JP a16
+// 3 16
 // - - - -
-void CPU::op_ld_b_h() {
-    this->registers_.B = this->registers_.H;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x45
-// LD B, L
-// 1 4
-// - - - -
-void CPU::op_ld_b_l() {
-    this->registers_.B = this->registers_.L;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x46
-// LD B, [HL]
-// 1 8
-// - - - -
-void CPU::op_ld_b_hlm() {
-    this->registers_.B = this->memory_.read_byte(this->registers_.get_hl());
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0x47
-// LD B, A
-// 1 4
-// - - - -
-void CPU::op_ld_b_a() {
-    this->registers_.B = this->registers_.A;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x48
-// LD C, B
-// 1 4
-// - - - -
-void CPU::op_ld_c_b() {
-    this->registers_.C = this->registers_.B;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x49
-// LD C, C
-// 1 4
-// - - - -
-void CPU::op_ld_c_c() {
-    this->registers_.C = this->registers_.C;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x4a
-// LD C, D
-// 1 4
-// - - - -
-void CPU::op_ld_c_d() {
-    this->registers_.C = this->registers_.D;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x4b
-// LD C, E
-// 1 4
-// - - - -
-void CPU::op_ld_c_e() {
-    this->registers_.C = this->registers_.E;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x4c
-// LD C, H
-// 1 4
-// - - - -
-void CPU::op_ld_c_h() {
-    this->registers_.C = this->registers_.H;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x4d
-// LD C, L
-// 1 4
-// - - - -
-void CPU::op_ld_c_l() {
-    this->registers_.C = this->registers_.L;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x4e
-// LD C, [HL]
-// 1 8
-// - - - -
-void CPU::op_ld_c_hlm() {
-    this->registers_.C = this->memory_.read_byte(this->registers_.get_hl());
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0x4f
-// LD C, A
-// 1 4
-// - - - -
-void CPU::op_ld_c_a() {
-    this->registers_.C = this->registers_.A;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x50
-// LD D, B
-// 1 4
-// - - - -
-void CPU::op_ld_d_b() {
-    this->registers_.D = this->registers_.B;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x51
-// LD D, C
-// 1 4
-// - - - -
-void CPU::op_ld_d_c() {
-    this->registers_.D = this->registers_.C;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x52
-// LD D, D
-// 1 4
-// - - - -
-void CPU::op_ld_d_d() {
-    this->registers_.D = this->registers_.D;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x53
-// LD D, E
-// 1 4
-// - - - -
-void CPU::op_ld_d_e() {
-    this->registers_.D = this->registers_.E;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x54
-// LD D, H
-// 1 4
-// - - - -
-void CPU::op_ld_d_h() {
-    this->registers_.D = this->registers_.H;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x55
-// LD D, L
-// 1 4
-// - - - -
-void CPU::op_ld_d_l() {
-    this->registers_.D = this->registers_.L;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x56
-// LD D, [HL]
-// 1 8
-// - - - -
-void CPU::op_ld_d_hlm() {
-    this->registers_.D = this->memory_.read_byte(this->registers_.get_hl());
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0x57
-// LD D, A
-// 1 4
-// - - - -
-void CPU::op_ld_d_a() {
-    this->registers_.D = this->registers_.A;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x58
-// LD E, B
-// 1 4
-// - - - -
-void CPU::op_ld_e_b() {
-    this->registers_.E = this->registers_.B;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x59
-// LD E, C
-// 1 4
-// - - - -
-void CPU::op_ld_e_c() {
-    this->registers_.E = this->registers_.C;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x5a
-// LD E, D
-// 1 4
-// - - - -
-void CPU::op_ld_e_d() {
-    this->registers_.E = this->registers_.D;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x5b
-// LD E, E
-// 1 4
-// - - - -
-void CPU::op_ld_e_e() {
-    this->registers_.E = this->registers_.E;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x5c
-// LD E, H
-// 1 4
-// - - - -
-void CPU::op_ld_e_h() {
-    this->registers_.E = this->registers_.H;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x5d
-// LD E, L
-// 1 4
-// - - - -
-void CPU::op_ld_e_l() {
-    this->registers_.E = this->registers_.L;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x5e
-// LD E, [HL]
-// 1 8
-// - - - -
-void CPU::op_ld_e_hlm() {
-    this->registers_.E = this->memory_.read_byte(this->registers_.get_hl());
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0x5f
-// LD E, A
-// 1 4
-// - - - -
-void CPU::op_ld_e_a() {
-    this->registers_.E = this->registers_.A;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x60
-// LD H, B
-// 1 4
-// - - - -
-void CPU::op_ld_h_b() {
-    this->registers_.H = this->registers_.B;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x61
-// LD H, C
-// 1 4
-// - - - -
-void CPU::op_ld_h_c() {
-    this->registers_.H = this->registers_.C;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x62
-// LD H, D
-// 1 4
-// - - - -
-void CPU::op_ld_h_d() {
-    this->registers_.H = this->registers_.D;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x63
-// LD H, E
-// 1 4
-// - - - -
-void CPU::op_ld_h_e() {
-    this->registers_.H = this->registers_.E;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x64
-// LD H, H
-// 1 4
-// - - - -
-void CPU::op_ld_h_h() {
-    this->registers_.H = this->registers_.H;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x65
-// LD H, L
-// 1 4
-// - - - -
-void CPU::op_ld_h_l() {
-    this->registers_.H = this->registers_.L;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x66
-// LD H, [HL]
-// 1 8
-// - - - -
-void CPU::op_ld_h_hlm() {
-    this->registers_.H = this->memory_.read_byte(this->registers_.get_hl());
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0x67
-// LD H, A
-// 1 4
-// - - - -
-void CPU::op_ld_h_a() {
-    this->registers_.H = this->registers_.A;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x68
-// LD L, B
-// 1 4
-// - - - -
-void CPU::op_ld_l_b() {
-    this->registers_.L = this->registers_.B;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x69
-// LD L, C
-// 1 4
-// - - - -
-void CPU::op_ld_l_c() {
-    this->registers_.L = this->registers_.C;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x6a
-// LD L, D
-// 1 4
-// - - - -
-void CPU::op_ld_l_d() {
-    this->registers_.L = this->registers_.D;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x6b
-// LD L, E
-// 1 4
-// - - - -
-void CPU::op_ld_l_e() {
-    this->registers_.L = this->registers_.E;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x6c
-// LD L, H
-// 1 4
-// - - - -
-void CPU::op_ld_l_h() {
-    this->registers_.L = this->registers_.H;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x6d
-// LD L, L
-// 1 4
-// - - - -
-void CPU::op_ld_l_l() {
-    this->registers_.L = this->registers_.L;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x6e
-// LD L, [HL]
-// 1 8
-// - - - -
-void CPU::op_ld_l_hlm() {
-    this->registers_.L = this->memory_.read_byte(this->registers_.get_hl());
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0x6f
-// LD L, A
-// 1 4
-// - - - -
-void CPU::op_ld_l_a() {
-    this->registers_.L = this->registers_.A;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x70
-// LD [HL], B
-// 1 8
-// - - - -
-void CPU::op_ld_hlm_b() {
-    this->memory_.write_byte(this->registers_.get_hl(), this->registers_.B);
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0x71
-// LD [HL], C
-// 1 8
-// - - - -
-void CPU::op_ld_hlm_c() {
-    this->memory_.write_byte(this->registers_.get_hl(), this->registers_.C);
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0x72
-// LD [HL], D
-// 1 8
-// - - - -
-void CPU::op_ld_hlm_d() {
-    this->memory_.write_byte(this->registers_.get_hl(), this->registers_.D);
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0x73
-// LD [HL], E
-// 1 8
-// - - - -
-void CPU::op_ld_hlm_e() {
-    this->memory_.write_byte(this->registers_.get_hl(), this->registers_.E);
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0x74
-// LD [HL], H
-// 1 8
-// - - - -
-void CPU::op_ld_hlm_h() {
-    this->memory_.write_byte(this->registers_.get_hl(), this->registers_.H);
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0x75
-// LD [HL], L
-// 1 8
-// - - - -
-void CPU::op_ld_hlm_l() {
-    this->memory_.write_byte(this->registers_.get_hl(), this->registers_.L);
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0x76
-// HALT
-// 1 4
-// - - - -
-void CPU::op_halt() {
-    const uint8_t pending = static_cast<uint8_t>(this->memory_.get_ie() & this->memory_.get_if() & 0x1F);
-
-    // HALT bug case: IME=0 and an interrupt is pending.
-    // CPU does not actually enter halted state.
-    if (this->registers_.IME == false && pending != 0) {
-        this->halt_bug_active = true;
-    } else {
-        this->halted = true;
-    }
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x77
-// LD [HL], A
-// 1 8
-// - - - -
-void CPU::op_ld_hlm_a() {
-    this->memory_.write_byte(this->registers_.get_hl(), this->registers_.A);
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0x78
-// LD A, B
-// 1 4
-// - - - -
-void CPU::op_ld_a_b() {
-    this->registers_.A = this->registers_.B;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x79
-// LD A, C
-// 1 4
-// - - - -
-void CPU::op_ld_a_c() {
-    this->registers_.A = this->registers_.C;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x7a
-// LD A, D
-// 1 4
-// - - - -
-void CPU::op_ld_a_d() {
-    this->registers_.A = this->registers_.D;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x7b
-// LD A, E
-// 1 4
-// - - - -
-void CPU::op_ld_a_e() {
-    this->registers_.A = this->registers_.E;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x7c
-// LD A, H
-// 1 4
-// - - - -
-void CPU::op_ld_a_h() {
-    this->registers_.A = this->registers_.H;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x7d
-// LD A, L
-// 1 4
-// - - - -
-void CPU::op_ld_a_l() {
-    this->registers_.A = this->registers_.L;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x7e
-// LD A, [HL]
-// 1 8
-// - - - -
-void CPU::op_ld_a_hlm() {
-    this->registers_.A = this->memory_.read_byte(this->registers_.get_hl());
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0x7f
-// LD A, A
-// 1 4
-// - - - -
-void CPU::op_ld_a_a() {
-    this->registers_.A = this->registers_.A;
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x80
-// ADD A, B
-// 1 4
-// Z 0 H C
-void CPU::op_add_a_b() {
-    this->alu_.add_u8(this->registers_.B);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x81
-// ADD A, C
-// 1 4
-// Z 0 H C
-void CPU::op_add_a_c() {
-    this->alu_.add_u8(this->registers_.C);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x82
-// ADD A, D
-// 1 4
-// Z 0 H C
-void CPU::op_add_a_d() {
-    this->alu_.add_u8(this->registers_.D);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x83
-// ADD A, E
-// 1 4
-// Z 0 H C
-void CPU::op_add_a_e() {
-    this->alu_.add_u8(this->registers_.E);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x84
-// ADD A, H
-// 1 4
-// Z 0 H C
-void CPU::op_add_a_h() {
-    this->alu_.add_u8(this->registers_.H);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x85
-// ADD A, L
-// 1 4
-// Z 0 H C
-void CPU::op_add_a_l() {
-    this->alu_.add_u8(this->registers_.L);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x86
-// ADD A, [HL]
-// 1 8
-// Z 0 H C
-void CPU::op_add_a_hlm() {
-    uint8_t value = this->memory_.read_byte(this->registers_.get_hl());
-    this->alu_.add_u8(value);
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0x87
-// ADD A, A
-// 1 4
-// Z 0 H C
-void CPU::op_add_a_a() {
-    this->alu_.add_u8(this->registers_.A);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x88
-// ADC A, B
-// 1 4
-// Z 0 H C
-void CPU::op_adc_a_b() {
-    this->alu_.adc_u8(this->registers_.B);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x89
-// ADC A, C
-// 1 4
-// Z 0 H C
-void CPU::op_adc_a_c() {
-    this->alu_.adc_u8(this->registers_.C);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x8a
-// ADC A, D
-// 1 4
-// Z 0 H C
-void CPU::op_adc_a_d() {
-    this->alu_.adc_u8(this->registers_.D);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x8b
-// ADC A, E
-// 1 4
-// Z 0 H C
-void CPU::op_adc_a_e() {
-    this->alu_.adc_u8(this->registers_.E);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x8c
-// ADC A, H
-// 1 4
-// Z 0 H C
-void CPU::op_adc_a_h() {
-    this->alu_.adc_u8(this->registers_.H);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x8d
-// ADC A, L
-// 1 4
-// Z 0 H C
-void CPU::op_adc_a_l() {
-    this->alu_.adc_u8(this->registers_.L);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x8e
-// ADC A, [HL]
-// 1 8
-// Z 0 H C
-void CPU::op_adc_a_hlm() {
-    uint8_t value = this->memory_.read_byte(this->registers_.get_hl());
-    this->alu_.adc_u8(value);
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0x8f
-// ADC A, A
-// 1 4
-// Z 0 H C
-void CPU::op_adc_a_a() {
-    this->alu_.adc_u8(this->registers_.A);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x90
-// SUB A, B
-// 1 4
-// Z 1 H C
-void CPU::op_sub_a_b() {
-    this->alu_.sub_u8(this->registers_.B);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x91
-// SUB A, C
-// 1 4
-// Z 1 H C
-void CPU::op_sub_a_c() {
-    this->alu_.sub_u8(this->registers_.C);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x92
-// SUB A, D
-// 1 4
-// Z 1 H C
-void CPU::op_sub_a_d() {
-    this->alu_.sub_u8(this->registers_.D);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x93
-// SUB A, E
-// 1 4
-// Z 1 H C
-void CPU::op_sub_a_e() {
-    this->alu_.sub_u8(this->registers_.E);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x94
-// SUB A, H
-// 1 4
-// Z 1 H C
-void CPU::op_sub_a_h() {
-    this->alu_.sub_u8(this->registers_.H);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x95
-// SUB A, L
-// 1 4
-// Z 1 H C
-void CPU::op_sub_a_l() {
-    this->alu_.sub_u8(this->registers_.L);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x96
-// SUB A, [HL]
-// 1 8
-// Z 1 H C
-void CPU::op_sub_a_hlm() {
-    uint8_t value = this->memory_.read_byte(this->registers_.get_hl());
-    this->alu_.sub_u8(value);
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0x97
-// SUB A, A
-// 1 4
-// Z 1 H C
-void CPU::op_sub_a_a() {
-    this->alu_.sub_u8(this->registers_.A);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x98
-// SBC A, B
-// 1 4
-// Z 1 H C
-void CPU::op_sbc_a_b() {
-    this->alu_.sbc_u8(this->registers_.B);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x99
-// SBC A, C
-// 1 4
-// Z 1 H C
-void CPU::op_sbc_a_c() {
-    this->alu_.sbc_u8(this->registers_.C);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x9a
-// SBC A, D
-// 1 4
-// Z 1 H C
-void CPU::op_sbc_a_d() {
-    this->alu_.sbc_u8(this->registers_.D);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x9b
-// SBC A, E
-// 1 4
-// Z 1 H C
-void CPU::op_sbc_a_e() {
-    this->alu_.sbc_u8(this->registers_.E);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x9c
-// SBC A, H
-// 1 4
-// Z 1 H C
-void CPU::op_sbc_a_h() {
-    this->alu_.sbc_u8(this->registers_.H);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x9d
-// SBC A, L
-// 1 4
-// Z 1 H C
-void CPU::op_sbc_a_l() {
-    this->alu_.sbc_u8(this->registers_.L);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0x9e
-// SBC A, [HL]
-// 1 8
-// Z 1 H C
-void CPU::op_sbc_a_hlm() {
-    uint8_t value = this->memory_.read_byte(this->registers_.get_hl());
-    this->alu_.sbc_u8(value);
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0x9f
-// SBC A, A
-// 1 4
-// Z 1 H C
-void CPU::op_sbc_a_a() {
-    this->alu_.sbc_u8(this->registers_.A);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xa0
-// AND A, B
-// 1 4
-// Z 0 1 0
-void CPU::op_and_a_b() {
-    this->alu_.and_u8(this->registers_.B);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xa1
-// AND A, C
-// 1 4
-// Z 0 1 0
-void CPU::op_and_a_c() {
-    this->alu_.and_u8(this->registers_.C);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xa2
-// AND A, D
-// 1 4
-// Z 0 1 0
-void CPU::op_and_a_d() {
-    this->alu_.and_u8(this->registers_.D);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xa3
-// AND A, E
-// 1 4
-// Z 0 1 0
-void CPU::op_and_a_e() {
-    this->alu_.and_u8(this->registers_.E);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xa4
-// AND A, H
-// 1 4
-// Z 0 1 0
-void CPU::op_and_a_h() {
-    this->alu_.and_u8(this->registers_.H);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xa5
-// AND A, L
-// 1 4
-// Z 0 1 0
-void CPU::op_and_a_l() {
-    this->alu_.and_u8(this->registers_.L);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xa6
-// AND A, [HL]
-// 1 8
-// Z 0 1 0
-void CPU::op_and_a_hlm() {
-    uint8_t value = this->memory_.read_byte(this->registers_.get_hl());
-    this->alu_.and_u8(value);
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0xa7
-// AND A, A
-// 1 4
-// Z 0 1 0
-void CPU::op_and_a_a() {
-    this->alu_.and_u8(this->registers_.A);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xa8
-// XOR A, B
-// 1 4
-// Z 0 0 0
-void CPU::op_xor_a_b() {
-    this->alu_.xor_u8(this->registers_.B);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xa9
-// XOR A, C
-// 1 4
-// Z 0 0 0
-void CPU::op_xor_a_c() {
-    this->alu_.xor_u8(this->registers_.C);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xaa
-// XOR A, D
-// 1 4
-// Z 0 0 0
-void CPU::op_xor_a_d() {
-    this->alu_.xor_u8(this->registers_.D);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xab
-// XOR A, E
-// 1 4
-// Z 0 0 0
-void CPU::op_xor_a_e() {
-    this->alu_.xor_u8(this->registers_.E);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xac
-// XOR A, H
-// 1 4
-// Z 0 0 0
-void CPU::op_xor_a_h() {
-    this->alu_.xor_u8(this->registers_.H);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xad
-// XOR A, L
-// 1 4
-// Z 0 0 0
-void CPU::op_xor_a_l() {
-    this->alu_.xor_u8(this->registers_.L);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xae
-// XOR A, [HL]
-// 1 8
-// Z 0 0 0
-void CPU::op_xor_a_hlm() {
-    uint8_t value = this->memory_.read_byte(this->registers_.get_hl());
-    this->alu_.xor_u8(value);
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0xaf
-// XOR A, A
-// 1 4
-// Z 0 0 0
-void CPU::op_xor_a_a() {
-    this->alu_.xor_u8(this->registers_.A);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xb0
-// OR A, B
-// 1 4
-// Z 0 0 0
-void CPU::op_or_a_b() {
-    this->alu_.or_u8(this->registers_.B);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xb1
-// OR A, C
-// 1 4
-// Z 0 0 0
-void CPU::op_or_a_c() {
-    this->alu_.or_u8(this->registers_.C);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xb2
-// OR A, D
-// 1 4
-// Z 0 0 0
-void CPU::op_or_a_d() {
-    this->alu_.or_u8(this->registers_.D);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xb3
-// OR A, E
-// 1 4
-// Z 0 0 0
-void CPU::op_or_a_e() {
-    this->alu_.or_u8(this->registers_.E);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xb4
-// OR A, H
-// 1 4
-// Z 0 0 0
-void CPU::op_or_a_h() {
-    this->alu_.or_u8(this->registers_.H);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xb5
-// OR A, L
-// 1 4
-// Z 0 0 0
-void CPU::op_or_a_l() {
-    this->alu_.or_u8(this->registers_.L);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xb6
-// OR A, [HL]
-// 1 8
-// Z 0 0 0
-void CPU::op_or_a_hlm() {
-    uint8_t value = this->memory_.read_byte(this->registers_.get_hl());
-    this->alu_.or_u8(value);
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0xb7
-// OR A, A
-// 1 4
-// Z 0 0 0
-void CPU::op_or_a_a() {
-    this->alu_.or_u8(this->registers_.A);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xb8
-// CP A, B
-// 1 4
-// Z 1 H C
-void CPU::op_cp_a_b() {
-    this->alu_.cp_u8(this->registers_.B);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xb9
-// CP A, C
-// 1 4
-// Z 1 H C
-void CPU::op_cp_a_c() {
-    this->alu_.cp_u8(this->registers_.C);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xba
-// CP A, D
-// 1 4
-// Z 1 H C
-void CPU::op_cp_a_d() {
-    this->alu_.cp_u8(this->registers_.D);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xbb
-// CP A, E
-// 1 4
-// Z 1 H C
-void CPU::op_cp_a_e() {
-    this->alu_.cp_u8(this->registers_.E);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xbc
-// CP A, H
-// 1 4
-// Z 1 H C
-void CPU::op_cp_a_h() {
-    this->alu_.cp_u8(this->registers_.H);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xbd
-// CP A, L
-// 1 4
-// Z 1 H C
-void CPU::op_cp_a_l() {
-    this->alu_.cp_u8(this->registers_.L);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xbe
-// CP A, [HL]
-// 1 8
-// Z 1 H C
-void CPU::op_cp_a_hlm() {
-    uint8_t value = this->memory_.read_byte(this->registers_.get_hl());
-    this->alu_.cp_u8(value);
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0xbf
-// CP A, A
-// 1 4
-// 1 1 0 0
-void CPU::op_cp_a_a() {
-    this->alu_.cp_u8(this->registers_.A);
-    this->registers_.set_flag_z(true);
-    this->registers_.set_flag_n(true);
-    this->registers_.set_flag_h(false);
-    this->registers_.set_flag_c(false);
-    this->registers_.PC += 1;
-    this->tstates += 4;
-}
-
-// 0xc0
-// RET NZ
-// 1 20/8
-// - - - -
-void CPU::op_ret_nz() {
-    if (!this->registers_.get_flag_z()) {
-        uint16_t address = this->stack_.pop_word();
-        this->registers_.PC = address;
-        this->tstates += 20;
-        return;
-    }
-    this->registers_.PC += 1;
-    this->tstates += 8;
-}
-
-// 0xc1
-// POP BC
-// 1 12
-// - - - -
-void CPU::op_pop_bc() {
-    uint16_t word = this->stack_.pop_word();
-    this->registers_.set_bc(word);
-    this->registers_.PC += 1;
-    this->tstates += 12;
-}
-
-// 0xc2
-// JP NZ, a16
-// 3 16/12
-// - - - -
-void CPU::op_jp_nz_a16() {
-    uint16_t address = this->memory_.read_word(static_cast<uint16_t>(this->registers_.PC + 1));
-    if (!this->registers_.get_flag_z()) {
-        this->registers_.PC = address;
-        this->tstates += 16;
-        return;
-    }
-    this->registers_.PC += 3;
-    this->tstates += 12;
-}
-
-// 0xc3
-// JP a16
-// 3 16
-// - - - -
-void CPU::op_jp_a16() {
-    uint16_t address = this->memory_.read_word(static_cast<uint16_t>(this->registers_.PC + 1));
-    this->registers_.PC = address;
-    this->tstates += 16;
+void CPU::op_jp_a16() {
+    uint16_t address = this->imm16();
+    this->registers_.PC = address;
+    this->tstates += 16;
 }
 
 // 0xc4
@@ -2210,7 +1654,7 @@ void CPU::op_jp_a16() {
 // 3 24/12
 // - - - -
 void CPU::op_call_nz_a16() {
-    uint16_t address = this->memory_.read_word(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint16_t address = this->imm16();
 
     if (!this->registers_.get_flag_z()) {
         uint16_t return_address = static_cast<uint16_t>(this->registers_.PC + 3);
@@ -2224,22 +1668,12 @@ void CPU::op_call_nz_a16() {
     this->tstates += 12;
 }
 
-// 0xc5
-// PUSH BC
-// 1 16
-// - - - -
-void CPU::op_push_bc() {
-    this->stack_.push_word(this->registers_.get_bc());
-    this->registers_.PC += 1;
-    this->tstates += 16;
-}
-
 // 0xc6
 // ADD A, n8
 // 2 8
 // Z 0 H C
 void CPU::op_add_a_n8() {
-    uint8_t value = this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint8_t value = this->imm8();
     this->alu_.add_u8(value);
     this->registers_.PC += 2;
     this->tstates += 8;
@@ -2285,7 +1719,7 @@ void CPU::op_ret() {
 // 3 16/12
 // - - - -
 void CPU::op_jp_z_a16() {
-    uint16_t address = this->memory_.read_word(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint16_t address = this->imm16();
     if (this->registers_.get_flag_z()) {
         this->registers_.PC = address;
         this->tstates += 16;
@@ -2300,7 +1734,7 @@ void CPU::op_jp_z_a16() {
 // 1 4
 // - - - -
 void CPU::op_prefix() {
-    uint8_t cb = this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint8_t cb = this->imm8();
     this->exec_cb(cb); // PC + Cycles handled in exec_cb
 }
 
@@ -2309,7 +1743,7 @@ void CPU::op_prefix() {
 // 3 24/12
 // - - - -
 void CPU::op_call_z_a16() {
-    uint16_t address = this->memory_.read_word(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint16_t address = this->imm16();
 
     if (this->registers_.get_flag_z()) {
         uint16_t return_address = static_cast<uint16_t>(this->registers_.PC + 3);
@@ -2328,7 +1762,7 @@ void CPU::op_call_z_a16() {
 // 3 24
 // - - - -
 void CPU::op_call_a16() {
-    uint16_t address = this->memory_.read_word(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint16_t address = this->imm16();
 
     uint16_t return_address = static_cast<uint16_t>(this->registers_.PC + 3);
     this->stack_.push_word(return_address);
@@ -2342,7 +1776,7 @@ void CPU::op_call_a16() {
 // 2 8
 // Z 0 H C
 void CPU::op_adc_a_n8() {
-    uint8_t value = this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint8_t value = this->imm8();
     this->alu_.adc_u8(value);
     this->registers_.PC += 2;
     this->tstates += 8;
@@ -2373,23 +1807,12 @@ void CPU::op_ret_nc() {
     this->tstates += 8;
 }
 
-// 0xd1
-// POP DE
-// 1 12
-// - - - -
-void CPU::op_pop_de() {
-    uint16_t word = this->stack_.pop_word();
-    this->registers_.set_de(word);
-    this->registers_.PC += 1;
-    this->tstates += 12;
-}
-
 // 0xd2
 // JP NC, a16
 // 3 16/12
 // - - - -
 void CPU::op_jp_nc_a16() {
-    uint16_t address = this->memory_.read_word(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint16_t address = this->imm16();
     if (!this->registers_.get_flag_c()) {
         this->registers_.PC = address;
         this->tstates += 16;
@@ -2412,7 +1835,7 @@ void CPU::op_jp_nc_a16() {
 // 3 24/12
 // - - - -
 void CPU::op_call_nc_a16() {
-    uint16_t address = this->memory_.read_word(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint16_t address = this->imm16();
 
     if (!this->registers_.get_flag_c()) {
         uint16_t return_address = static_cast<uint16_t>(this->registers_.PC + 3);
@@ -2426,22 +1849,12 @@ void CPU::op_call_nc_a16() {
     this->tstates += 12;
 }
 
-// 0xd5
-// PUSH DE
-// 1 16
-// - - - -
-void CPU::op_push_de() {
-    this->stack_.push_word(this->registers_.get_de());
-    this->registers_.PC += 1;
-    this->tstates += 16;
-}
-
 // 0xd6
 // SUB A, n8
 // 2 8
 // Z 1 H C
 void CPU::op_sub_a_n8() {
-    uint8_t value = this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint8_t value = this->imm8();
     this->alu_.sub_u8(value);
     this->registers_.PC += 2;
     this->tstates += 8;
@@ -2488,7 +1901,7 @@ void CPU::op_reti() {
 // 3 16/12
 // - - - -
 void CPU::op_jp_c_a16() {
-    uint16_t address = this->memory_.read_word(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint16_t address = this->imm16();
     if (this->registers_.get_flag_c()) {
         this->registers_.PC = address;
         this->tstates += 16;
@@ -2511,7 +1924,7 @@ void CPU::op_jp_c_a16() {
 // 3 24/12
 // - - - -
 void CPU::op_call_c_a16() {
-    uint16_t address = this->memory_.read_word(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint16_t address = this->imm16();
 
     if (this->registers_.get_flag_c()) {
         uint16_t return_address = static_cast<uint16_t>(this->registers_.PC + 3);
@@ -2538,7 +1951,7 @@ void CPU::op_call_c_a16() {
 // 2 8
 // Z 1 H C
 void CPU::op_sbc_a_n8() {
-    uint8_t value = this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint8_t value = this->imm8();
     this->alu_.sbc_u8(value);
     this->registers_.PC += 2;
     this->tstates += 8;
@@ -2560,23 +1973,12 @@ void CPU::op_rst_18() {
 // - - - -
 // Notes: a8 means 8-bit unsigned data, which is added to $FF00 in certain instructions to create a 16-bit address in HRAM (High RAM)
 void CPU::op_ldh_a8m_a() {
-    uint16_t address = 0xFF00 + static_cast<uint16_t>(this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1)));
+    uint16_t address = 0xFF00 + static_cast<uint16_t>(this->imm8());
     this->memory_.write_byte(address, this->registers_.A);
     this->registers_.PC += 2;
     this->tstates += 12;
 }
 
-// 0xe1
-// POP HL
-// 1 12
-// - - - -
-void CPU::op_pop_hl() {
-    uint16_t word = this->stack_.pop_word();
-    this->registers_.set_hl(word);
-    this->registers_.PC += 1;
-    this->tstates += 12;
-}
-
 // 0xe2
 // LDH [C], A
 // 1 8
@@ -2605,22 +2007,12 @@ void CPU::op_ldh_cm_a() {
 //     return 0;
 // }
 
-// 0xe5
-// PUSH HL
-// 1 16
-// - - - -
-void CPU::op_push_hl() {
-    this->stack_.push_word(this->registers_.get_hl());
-    this->registers_.PC += 1;
-    this->tstates += 16;
-}
-
 // 0xe6
 // AND A, n8
 // 2 8
 // Z 0 1 0
 void CPU::op_and_a_n8() {
-    uint8_t value = this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint8_t value = this->imm8();
     this->alu_.and_u8(value);
     this->registers_.PC += 2;
     this->tstates += 8;
@@ -2641,7 +2033,7 @@ void CPU::op_rst_20() {
 // 2 16
 // 0 0 H C
 void CPU::op_add_sp_e8() {
-    int8_t value = static_cast<int8_t>(this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1)));
+    int8_t value = static_cast<int8_t>(this->imm8());
     uint16_t sp = this->registers_.SP;
     uint16_t result = static_cast<uint16_t>(static_cast<int32_t>(sp) + static_cast<int32_t>(value));
     this->registers_.SP = result;
@@ -2649,10 +2041,8 @@ void CPU::op_add_sp_e8() {
     uint8_t value_u = static_cast<uint8_t>(value);
 
     // Flags
-    this->registers_.set_flag_z(false);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(((sp & 0x0F) + (value_u & 0x0F)) > 0x0F);
-    this->registers_.set_flag_c((static_cast<uint16_t>(sp & 0xFF) + value_u) > 0xFF);
+    this->registers_.set_flags(false, false, ((sp & 0x0F) + (value_u & 0x0F)) > 0x0F,
+                               (static_cast<uint16_t>(sp & 0xFF) + value_u) > 0xFF);
 
     this->registers_.PC += 2;
     this->tstates += 16;
@@ -2672,7 +2062,7 @@ void CPU::op_jp_hl() {
 // 3 16
 // - - - -
 void CPU::op_ld_a16m_a() {
-    this->memory_.write_byte(this->memory_.read_word(static_cast<uint16_t>(this->registers_.PC + 1)), this->registers_.A);
+    this->memory_.write_byte(this->imm16(), this->registers_.A);
     this->registers_.PC += 3;
     this->tstates += 16;
 }
@@ -2706,7 +2096,7 @@ void CPU::op_ld_a16m_a() {
 // 2 8
 // Z 0 0 0
 void CPU::op_xor_a_n8() {
-    uint8_t value = this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint8_t value = this->imm8();
     this->alu_.xor_u8(value);
     this->registers_.PC += 2;
     this->tstates += 8;
@@ -2728,23 +2118,12 @@ void CPU::op_rst_28() {
 // - - - -
 // Notes: a8 means 8-bit unsigned data, which is added to $FF00 in certain instructions to create a 16-bit address in HRAM (High RAM)
 void CPU::op_ldh_a_a8m() {
-    uint16_t address = 0xFF00 + static_cast<uint16_t>(this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1)));
+    uint16_t address = 0xFF00 + static_cast<uint16_t>(this->imm8());
     this->registers_.A = this->memory_.read_byte(address);
     this->registers_.PC += 2;
     this->tstates += 12;
 }
 
-// 0xf1
-// POP AF
-// 1 12
-// Z N H C
-void CPU::op_pop_af() {
-    uint16_t word = this->stack_.pop_word();
-    this->registers_.set_af(word);
-    this->registers_.PC += 1;
-    this->tstates += 12;
-}
-
 // 0xf2
 // LDH A, [C]
 // 1 8
@@ -2777,22 +2156,12 @@ void CPU::op_di() {
 //     return 0;
 // }
 
-// 0xf5
-// PUSH AF
-// 1 16
-// - - - -
-void CPU::op_push_af() {
-    this->stack_.push_word(this->registers_.get_af());
-    this->registers_.PC += 1;
-    this->tstates += 16;
-}
-
 // 0xf6
 // OR A, n8
 // 2 8
 // Z 0 0 0
 void CPU::op_or_a_n8() {
-    uint8_t value = this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint8_t value = this->imm8();
     this->alu_.or_u8(value);
     this->registers_.PC += 2;
     this->tstates += 8;
@@ -2813,16 +2182,14 @@ void CPU::op_rst_30() {
 // 3 12
 // 0 0 H C
 void CPU::op_ld_hl_sp_e8() {
-    int8_t offset = static_cast<int8_t>(this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1)));
+    int8_t offset = static_cast<int8_t>(this->imm8());
     uint16_t sp = this->registers_.SP;
     uint16_t result = static_cast<uint16_t>(static_cast<int32_t>(sp) + static_cast<int32_t>(offset));
     this->registers_.set_hl(result);
 
     // Flags
-    this->registers_.set_flag_z(false);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h(((sp & 0x0F) + (static_cast<uint8_t>(offset) & 0x0F)) > 0x0F);
-    this->registers_.set_flag_c((static_cast<uint16_t>(sp & 0xFF) + static_cast<uint8_t>(offset)) > 0xFF);
+    this->registers_.set_flags(false, false, ((sp & 0x0F) + (static_cast<uint8_t>(offset) & 0x0F)) > 0x0F,
+                               (static_cast<uint16_t>(sp & 0xFF) + static_cast<uint8_t>(offset)) > 0xFF);
 
     this->registers_.PC += 2;
     this->tstates += 12;
@@ -2843,7 +2210,7 @@ void CPU::op_ld_sp_hl() {
 // 3 16
 // - - - -
 void CPU::op_ld_a_a16m() {
-    uint16_t address = this->memory_.read_word(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint16_t address = this->imm16();
     uint8_t value = this->memory_.read_byte(address);
     this->registers_.A = value;
     this->registers_.PC += 3;
@@ -2881,7 +2248,7 @@ void CPU::op_ei() {
 // 2 8
 // Z 1 H C
 void CPU::op_cp_a_n8() {
-    uint8_t value = this->memory_.read_byte(static_cast<uint16_t>(this->registers_.PC + 1));
+    uint8_t value = this->imm8();
     this->alu_.cp_u8(value);
     this->registers_.PC += 2;
     this->tstates += 8;
@@ -2910,16 +2277,16 @@ void CPU::init() {
     set(0x01, &CPU::op_ld_bc_n16,    "LD BC, n16");
     set(0x02, &CPU::op_ld_bcm_a,     "LD [BC], A");
     set(0x03, &CPU::op_inc_bc,       "INC BC");
-    set(0x04, &CPU::op_inc_b,        "INC B");
-    set(0x05, &CPU::op_dec_b,        "DEC B");
+    set(0x04, &CPU::op_inc_r<0x04>,        "INC B");
+    set(0x05, &CPU::op_dec_r<0x05>,        "DEC B");
     set(0x06, &CPU::op_ld_b_n8,      "LD B, n8");
     set(0x07, &CPU::op_rlca,         "RLCA");
     set(0x08, &CPU::op_ld_a16m_sp,   "LD [a16], SP");
     set(0x09, &CPU::op_add_hl_bc,    "ADD HL, BC");
     set(0x0A, &CPU::op_ld_a_bcm,     "LD A, [BC]");
     set(0x0B, &CPU::op_dec_bc,       "DEC BC");
-    set(0x0C, &CPU::op_inc_c,        "INC C");
-    set(0x0D, &CPU::op_dec_c,        "DEC C");
+    set(0x0C, &CPU::op_inc_r<0x0C>,        "INC C");
+    set(0x0D, &CPU::op_dec_r<0x0D>,        "DEC C");
     set(0x0E, &CPU::op_ld_c_n8,      "LD C, n8");
     set(0x0F, &CPU::op_rrca,         "RRCA");
 
@@ -2928,16 +2295,16 @@ void CPU::init() {
     set(0x11, &CPU::op_ld_de_n16,    "LD DE, n16");
     set(0x12, &CPU::op_ld_dem_a,     "LD [DE], A");
     set(0x13, &CPU::op_inc_de,       "INC DE");
-    set(0x14, &CPU::op_inc_d,        "INC D");
-    set(0x15, &CPU::op_dec_d,        "DEC D");
+    set(0x14, &CPU::op_inc_r<0x14>,        "INC D");
+    set(0x15, &CPU::op_dec_r<0x15>,        "DEC D");
     set(0x16, &CPU::op_ld_d_n8,      "LD D, n8");
     set(0x17, &CPU::op_rla,          "RLA");
     set(0x18, &CPU::op_jr_e8,        "JR e8");
     set(0x19, &CPU::op_add_hl_de,    "ADD HL, DE");
     set(0x1A, &CPU::op_ld_a_dem,     "LD A, [DE]");
     set(0x1B, &CPU::op_dec_de,       "DEC DE");
-    set(0x1C, &CPU::op_inc_e,        "INC E");
-    set(0x1D, &CPU::op_dec_e,        "DEC E");
+    set(0x1C, &CPU::op_inc_r<0x1C>,        "INC E");
+    set(0x1D, &CPU::op_dec_r<0x1D>,        "DEC E");
     set(0x1E, &CPU::op_ld_e_n8,      "LD E, n8");
     set(0x1F, &CPU::op_rra,          "RRA");
 
@@ -2946,16 +2313,16 @@ void CPU::init() {
     set(0x21, &CPU::op_ld_hl_a16,    "LD HL, n16");
     set(0x22, &CPU::op_ld_hlim_a,    "LD [HL+], A");
     set(0x23, &CPU::op_inc_hl,       "INC HL");
-    set(0x24, &CPU::op_inc_h,        "INC H");
-    set(0x25, &CPU::op_dec_h,        "DEC H");
+    set(0x24, &CPU::op_inc_r<0x24>,        "INC H");
+    set(0x25, &CPU::op_dec_r<0x25>,        "DEC H");
     set(0x26, &CPU::op_ld_h_n8,      "LD H, n8");
     set(0x27, &CPU::op_daa,          "DAA");
     set(0x28, &CPU::op_jr_z_e8,      "JR Z, e8");
     set(0x29, &CPU::op_add_hl_hl,    "ADD HL, HL");
     set(0x2A, &CPU::op_ld_a_hlim,    "LD A, [HL+]");
     set(0x2B, &CPU::op_dec_hl,       "DEC HL");
-    set(0x2C, &CPU::op_inc_l,        "INC L");
-    set(0x2D, &CPU::op_dec_l,        "DEC L");
+    set(0x2C, &CPU::op_inc_r<0x2C>,        "INC L");
+    set(0x2D, &CPU::op_dec_r<0x2D>,        "DEC L");
     set(0x2E, &CPU::op_ld_l_n8,      "LD L, n8");
     set(0x2F, &CPU::op_cpl,          "CPL");
 
@@ -2964,170 +2331,170 @@ void CPU::init() {
     set(0x31, &CPU::op_ld_sp_a16,    "LD SP, n16");
     set(0x32, &CPU::op_ld_hldm_a,    "LD [HL-], A");
     set(0x33, &CPU::op_inc_sp,       "INC SP");
-    set(0x34, &CPU::op_inc_hlm,      "INC [HL]");
-    set(0x35, &CPU::op_dec_hlm,      "DEC [HL]");
+    set(0x34, &CPU::op_inc_r<0x34>,      "INC [HL]");
+    set(0x35, &CPU::op_dec_r<0x35>,      "DEC [HL]");
     set(0x36, &CPU::op_ld_hlm_n8,    "LD [HL], n8");
     set(0x37, &CPU::op_scf,          "SCF");
     set(0x38, &CPU::op_jr_c_e8,      "JR C, e8");
     set(0x39, &CPU::op_add_hl_sp,    "ADD HL, SP");
     set(0x3A, &CPU::op_ld_a_hldm,    "LD A, [HL-]");
     set(0x3B, &CPU::op_dec_sp,       "DEC SP");
-    set(0x3C, &CPU::op_inc_a,        "INC A");
-    set(0x3D, &CPU::op_dec_a,        "DEC A");
+    set(0x3C, &CPU::op_inc_r<0x3C>,        "INC A");
+    set(0x3D, &CPU::op_dec_r<0x3D>,        "DEC A");
     set(0x3E, &CPU::op_ld_a_n8,      "LD A, n8");
     set(0x3F, &CPU::op_ccf,          "CCF");
 
     // 0x40 - 0x4F
-    set(0x40, &CPU::op_ld_b_b,       "LD B, B");
-    set(0x41, &CPU::op_ld_b_c,       "LD B, C");
-    set(0x42, &CPU::op_ld_b_d,       "LD B, D");
-    set(0x43, &CPU::op_ld_b_e,       "LD B, E");
-    set(0x44, &CPU::op_ld_b_h,       "LD B, H");
-    set(0x45, &CPU::op_ld_b_l,       "LD B, L");
-    set(0x46, &CPU::op_ld_b_hlm,     "LD B, [HL]");
-    set(0x47, &CPU::op_ld_b_a,       "LD B, A");
-    set(0x48, &CPU::op_ld_c_b,       "LD C, B");
-    set(0x49, &CPU::op_ld_c_c,       "LD C, C");
-    set(0x4A, &CPU::op_ld_c_d,       "LD C, D");
-    set(0x4B, &CPU::op_ld_c_e,       "LD C, E");
-    set(0x4C, &CPU::op_ld_c_h,       "LD C, H");
-    set(0x4D, &CPU::op_ld_c_l,       "LD C, L");
-    set(0x4E, &CPU::op_ld_c_hlm,     "LD C, [HL]");
-    set(0x4F, &CPU::op_ld_c_a,       "LD C, A");
+    set(0x40, &CPU::op_ld_r_r<0x40>,       "LD B, B");
+    set(0x41, &CPU::op_ld_r_r<0x41>,       "LD B, C");
+    set(0x42, &CPU::op_ld_r_r<0x42>,       "LD B, D");
+    set(0x43, &CPU::op_ld_r_r<0x43>,       "LD B, E");
+    set(0x44, &CPU::op_ld_r_r<0x44>,       "LD B, H");
+    set(0x45, &CPU::op_ld_r_r<0x45>,       "LD B, L");
+    set(0x46, &CPU::op_ld_r_r<0x46>,     "LD B, [HL]");
+    set(0x47, &CPU::op_ld_r_r<0x47>,       "LD B, A");
+    set(0x48, &CPU::op_ld_r_r<0x48>,       "LD C, B");
+    set(0x49, &CPU::op_ld_r_r<0x49>,       "LD C, C");
+    set(0x4A, &CPU::op_ld_r_r<0x4A>,       "LD C, D");
+    set(0x4B, &CPU::op_ld_r_r<0x4B>,       "LD C, E");
+    set(0x4C, &CPU::op_ld_r_r<0x4C>,       "LD C, H");
+    set(0x4D, &CPU::op_ld_r_r<0x4D>,       "LD C, L");
+    set(0x4E, &CPU::op_ld_r_r<0x4E>,     "LD C, [HL]");
+    set(0x4F, &CPU::op_ld_r_r<0x4F>,       "LD C, A");
 
     // 0x50 - 0x5F
-    set(0x50, &CPU::op_ld_d_b,       "LD D, B");
-    set(0x51, &CPU::op_ld_d_c,       "LD D, C");
-    set(0x52, &CPU::op_ld_d_d,       "LD D, D");
-    set(0x53, &CPU::op_ld_d_e,       "LD D, E");
-    set(0x54, &CPU::op_ld_d_h,       "LD D, H");
-    set(0x55, &CPU::op_ld_d_l,       "LD D, L");
-    set(0x56, &CPU::op_ld_d_hlm,     "LD D, [HL]");
-    set(0x57, &CPU::op_ld_d_a,       "LD D, A");
-    set(0x58, &CPU::op_ld_e_b,       "LD E, B");
-    set(0x59, &CPU::op_ld_e_c,       "LD E, C");
-    set(0x5A, &CPU::op_ld_e_d,       "LD E, D");
-    set(0x5B, &CPU::op_ld_e_e,       "LD E, E");
-    set(0x5C, &CPU::op_ld_e_h,       "LD E, H");
-    set(0x5D, &CPU::op_ld_e_l,       "LD E, L");
-    set(0x5E, &CPU::op_ld_e_hlm,     "LD E, [HL]");
-    set(0x5F, &CPU::op_ld_e_a,       "LD E, A");
+    set(0x50, &CPU::op_ld_r_r<0x50>,       "LD D, B");
+    set(0x51, &CPU::op_ld_r_r<0x51>,       "LD D, C");
+    set(0x52, &CPU::op_ld_r_r<0x52>,       "LD D, D");
+    set(0x53, &CPU::op_ld_r_r<0x53>,       "LD D, E");
+    set(0x54, &CPU::op_ld_r_r<0x54>,       "LD D, H");
+    set(0x55, &CPU::op_ld_r_r<0x55>,       "LD D, L");
+    set(0x56, &CPU::op_ld_r_r<0x56>,     "LD D, [HL]");
+    set(0x57, &CPU::op_ld_r_r<0x57>,       "LD D, A");
+    set(0x58, &CPU::op_ld_r_r<0x58>,       "LD E, B");
+    set(0x59, &CPU::op_ld_r_r<0x59>,       "LD E, C");
+    set(0x5A, &CPU::op_ld_r_r<0x5A>,       "LD E, D");
+    set(0x5B, &CPU::op_ld_r_r<0x5B>,       "LD E, E");
+    set(0x5C, &CPU::op_ld_r_r<0x5C>,       "LD E, H");
+    set(0x5D, &CPU::op_ld_r_r<0x5D>,       "LD E, L");
+    set(0x5E, &CPU::op_ld_r_r<0x5E>,     "LD E, [HL]");
+    set(0x5F, &CPU::op_ld_r_r<0x5F>,       "LD E, A");
 
     // 0x60 - 0x6F
-    set(0x60, &CPU::op_ld_h_b,       "LD H, B");
-    set(0x61, &CPU::op_ld_h_c,       "LD H, C");
-    set(0x62, &CPU::op_ld_h_d,       "LD H, D");
-    set(0x63, &CPU::op_ld_h_e,       "LD H, E");
-    set(0x64, &CPU::op_ld_h_h,       "LD H, H");
-    set(0x65, &CPU::op_ld_h_l,       "LD H, L");
-    set(0x66, &CPU::op_ld_h_hlm,     "LD H, [HL]");
-    set(0x67, &CPU::op_ld_h_a,       "LD H, A");
-    set(0x68, &CPU::op_ld_l_b,       "LD L, B");
-    set(0x69, &CPU::op_ld_l_c,       "LD L, C");
-    set(0x6A, &CPU::op_ld_l_d,       "LD L, D");
-    set(0x6B, &CPU::op_ld_l_e,       "LD L, E");
-    set(0x6C, &CPU::op_ld_l_h,       "LD L, H");
-    set(0x6D, &CPU::op_ld_l_l,       "LD L, L");
-    set(0x6E, &CPU::op_ld_l_hlm,     "LD L, [HL]");
-    set(0x6F, &CPU::op_ld_l_a,       "LD L, A");
+    set(0x60, &CPU::op_ld_r_r<0x60>,       "LD H, B");
+    set(0x61, &CPU::op_ld_r_r<0x61>,       "LD H, C");
+    set(0x62, &CPU::op_ld_r_r<0x62>,       "LD H, D");
+    set(0x63, &CPU::op_ld_r_r<0x63>,       "LD H, E");
+    set(0x64, &CPU::op_ld_r_r<0x64>,       "LD H, H");
+    set(0x65, &CPU::op_ld_r_r<0x65>,       "LD H, L");
+    set(0x66, &CPU::op_ld_r_r<0x66>,     "LD H, [HL]");
+    set(0x67, &CPU::op_ld_r_r<0x67>,       "LD H, A");
+    set(0x68, &CPU::op_ld_r_r<0x68>,       "LD L, B");
+    set(0x69, &CPU::op_ld_r_r<0x69>,       "LD L, C");
+    set(0x6A, &CPU::op_ld_r_r<0x6A>,       "LD L, D");
+    set(0x6B, &CPU::op_ld_r_r<0x6B>,       "LD L, E");
+    set(0x6C, &CPU::op_ld_r_r<0x6C>,       "LD L, H");
+    set(0x6D, &CPU::op_ld_r_r<0x6D>,       "LD L, L");
+    set(0x6E, &CPU::op_ld_r_r<0x6E>,     "LD L, [HL]");
+    set(0x6F, &CPU::op_ld_r_r<0x6F>,       "LD L, A");
 
     // 0x70 - 0x7F
-    set(0x70, &CPU::op_ld_hlm_b,     "LD [HL], B");
-    set(0x71, &CPU::op_ld_hlm_c,     "LD [HL], C");
-    set(0x72, &CPU::op_ld_hlm_d,     "LD [HL], D");
-    set(0x73, &CPU::op_ld_hlm_e,     "LD [HL], E");
-    set(0x74, &CPU::op_ld_hlm_h,     "LD [HL], H");
-    set(0x75, &CPU::op_ld_hlm_l,     "LD [HL], L");
+    set(0x70, &CPU::op_ld_r_r<0x70>,     "LD [HL], B");
+    set(0x71, &CPU::op_ld_r_r<0x71>,     "LD [HL], C");
+    set(0x72, &CPU::op_ld_r_r<0x72>,     "LD [HL], D");
+    set(0x73, &CPU::op_ld_r_r<0x73>,     "LD [HL], E");
+    set(0x74, &CPU::op_ld_r_r<0x74>,     "LD [HL], H");
+    set(0x75, &CPU::op_ld_r_r<0x75>,     "LD [HL], L");
     set(0x76, &CPU::op_halt,         "HALT");
-    set(0x77, &CPU::op_ld_hlm_a,     "LD [HL], A");
-    set(0x78, &CPU::op_ld_a_b,       "LD A, B");
-    set(0x79, &CPU::op_ld_a_c,       "LD A, C");
-    set(0x7A, &CPU::op_ld_a_d,       "LD A, D");
-    set(0x7B, &CPU::op_ld_a_e,       "LD A, E");
-    set(0x7C, &CPU::op_ld_a_h,       "LD A, H");
-    set(0x7D, &CPU::op_ld_a_l,       "LD A, L");
-    set(0x7E, &CPU::op_ld_a_hlm,     "LD A, [HL]");
-    set(0x7F, &CPU::op_ld_a_a,       "LD A, A");
+    set(0x77, &CPU::op_ld_r_r<0x77>,     "LD [HL], A");
+    set(0x78, &CPU::op_ld_r_r<0x78>,       "LD A, B");
+    set(0x79, &CPU::op_ld_r_r<0x79>,       "LD A, C");
+    set(0x7A, &CPU::op_ld_r_r<0x7A>,       "LD A, D");
+    set(0x7B, &CPU::op_ld_r_r<0x7B>,       "LD A, E");
+    set(0x7C, &CPU::op_ld_r_r<0x7C>,       "LD A, H");
+    set(0x7D, &CPU::op_ld_r_r<0x7D>,       "LD A, L");
+    set(0x7E, &CPU::op_ld_r_r<0x7E>,     "LD A, [HL]");
+    set(0x7F, &CPU::op_ld_r_r<0x7F>,       "LD A, A");
 
     // 0x80 - 0x8F
-    set(0x80, &CPU::op_add_a_b,      "ADD A, B");
-    set(0x81, &CPU::op_add_a_c,      "ADD A, C");
-    set(0x82, &CPU::op_add_a_d,      "ADD A, D");
-    set(0x83, &CPU::op_add_a_e,      "ADD A, E");
-    set(0x84, &CPU::op_add_a_h,      "ADD A, H");
-    set(0x85, &CPU::op_add_a_l,      "ADD A, L");
-    set(0x86, &CPU::op_add_a_hlm,    "ADD A, [HL]");
-    set(0x87, &CPU::op_add_a_a,      "ADD A, A");
-    set(0x88, &CPU::op_adc_a_b,      "ADC A, B");
-    set(0x89, &CPU::op_adc_a_c,      "ADC A, C");
-    set(0x8A, &CPU::op_adc_a_d,      "ADC A, D");
-    set(0x8B, &CPU::op_adc_a_e,      "ADC A, E");
-    set(0x8C, &CPU::op_adc_a_h,      "ADC A, H");
-    set(0x8D, &CPU::op_adc_a_l,      "ADC A, L");
-    set(0x8E, &CPU::op_adc_a_hlm,    "ADC A, [HL]");
-    set(0x8F, &CPU::op_adc_a_a,      "ADC A, A");
+    set(0x80, &CPU::op_alu_a_r<0x80>,      "ADD A, B");
+    set(0x81, &CPU::op_alu_a_r<0x81>,      "ADD A, C");
+    set(0x82, &CPU::op_alu_a_r<0x82>,      "ADD A, D");
+    set(0x83, &CPU::op_alu_a_r<0x83>,      "ADD A, E");
+    set(0x84, &CPU::op_alu_a_r<0x84>,      "ADD A, H");
+    set(0x85, &CPU::op_alu_a_r<0x85>,      "ADD A, L");
+    set(0x86, &CPU::op_alu_a_r<0x86>,    "ADD A, [HL]");
+    set(0x87, &CPU::op_alu_a_r<0x87>,      "ADD A, A");
+    set(0x88, &CPU::op_alu_a_r<0x88>,      "ADC A, B");
+    set(0x89, &CPU::op_alu_a_r<0x89>,      "ADC A, C");
+    set(0x8A, &CPU::op_alu_a_r<0x8A>,      "ADC A, D");
+    set(0x8B, &CPU::op_alu_a_r<0x8B>,      "ADC A, E");
+    set(0x8C, &CPU::op_alu_a_r<0x8C>,      "ADC A, H");
+    set(0x8D, &CPU::op_alu_a_r<0x8D>,      "ADC A, L");
+    set(0x8E, &CPU::op_alu_a_r<0x8E>,    "ADC A, [HL]");
+    set(0x8F, &CPU::op_alu_a_r<0x8F>,      "ADC A, A");
 
     // 0x90 - 0x9F
-    set(0x90, &CPU::op_sub_a_b,      "SUB A, B");
-    set(0x91, &CPU::op_sub_a_c,      "SUB A, C");
-    set(0x92, &CPU::op_sub_a_d,      "SUB A, D");
-    set(0x93, &CPU::op_sub_a_e,      "SUB A, E");
-    set(0x94, &CPU::op_sub_a_h,      "SUB A, H");
-    set(0x95, &CPU::op_sub_a_l,      "SUB A, L");
-    set(0x96, &CPU::op_sub_a_hlm,    "SUB A, [HL]");
-    set(0x97, &CPU::op_sub_a_a,      "SUB A, A");
-    set(0x98, &CPU::op_sbc_a_b,      "SBC A, B");
-    set(0x99, &CPU::op_sbc_a_c,      "SBC A, C");
-    set(0x9A, &CPU::op_sbc_a_d,      "SBC A, D");
-    set(0x9B, &CPU::op_sbc_a_e,      "SBC A, E");
-    set(0x9C, &CPU::op_sbc_a_h,      "SBC A, H");
-    set(0x9D, &CPU::op_sbc_a_l,      "SBC A, L");
-    set(0x9E, &CPU::op_sbc_a_hlm,    "SBC A, [HL]");
-    set(0x9F, &CPU::op_sbc_a_a,      "SBC A, A");
+    set(0x90, &CPU::op_alu_a_r<0x90>,      "SUB A, B");
+    set(0x91, &CPU::op_alu_a_r<0x91>,      "SUB A, C");
+    set(0x92, &CPU::op_alu_a_r<0x92>,      "SUB A, D");
+    set(0x93, &CPU::op_alu_a_r<0x93>,      "SUB A, E");
+    set(0x94, &CPU::op_alu_a_r<0x94>,      "SUB A, H");
+    set(0x95, &CPU::op_alu_a_r<0x95>,      "SUB A, L");
+    set(0x96, &CPU::op_alu_a_r<0x96>,    "SUB A, [HL]");
+    set(0x97, &CPU::op_alu_a_r<0x97>,      "SUB A, A");
+    set(0x98, &CPU::op_alu_a_r<0x98>,      "SBC A, B");
+    set(0x99, &CPU::op_alu_a_r<0x99>,      "SBC A, C");
+    set(0x9A, &CPU::op_alu_a_r<0x9A>,      "SBC A, D");
+    set(0x9B, &CPU::op_alu_a_r<0x9B>,      "SBC A, E");
+    set(0x9C, &CPU::op_alu_a_r<0x9C>,      "SBC A, H");
+    set(0x9D, &CPU::op_alu_a_r<0x9D>,      "SBC A, L");
+    set(0x9E, &CPU::op_alu_a_r<0x9E>,    "SBC A, [HL]");
+    set(0x9F, &CPU::op_alu_a_r<0x9F>,      "SBC A, A");
 
     // 0xA0 - 0xAF
-    set(0xA0, &CPU::op_and_a_b,      "AND A, B");
-    set(0xA1, &CPU::op_and_a_c,      "AND A, C");
-    set(0xA2, &CPU::op_and_a_d,      "AND A, D");
-    set(0xA3, &CPU::op_and_a_e,      "AND A, E");
-    set(0xA4, &CPU::op_and_a_h,      "AND A, H");
-    set(0xA5, &CPU::op_and_a_l,      "AND A, L");
-    set(0xA6, &CPU::op_and_a_hlm,    "AND A, [HL]");
-    set(0xA7, &CPU::op_and_a_a,      "AND A, A");
-    set(0xA8, &CPU::op_xor_a_b,      "XOR A, B");
-    set(0xA9, &CPU::op_xor_a_c,      "XOR A, C");
-    set(0xAA, &CPU::op_xor_a_d,      "XOR A, D");
-    set(0xAB, &CPU::op_xor_a_e,      "XOR A, E");
-    set(0xAC, &CPU::op_xor_a_h,      "XOR A, H");
-    set(0xAD, &CPU::op_xor_a_l,      "XOR A, L");
-    set(0xAE, &CPU::op_xor_a_hlm,    "XOR A, [HL]");
-    set(0xAF, &CPU::op_xor_a_a,      "XOR A, A");
+    set(0xA0, &CPU::op_alu_a_r<0xA0>,      "AND A, B");
+    set(0xA1, &CPU::op_alu_a_r<0xA1>,      "AND A, C");
+    set(0xA2, &CPU::op_alu_a_r<0xA2>,      "AND A, D");
+    set(0xA3, &CPU::op_alu_a_r<0xA3>,      "AND A, E");
+    set(0xA4, &CPU::op_alu_a_r<0xA4>,      "AND A, H");
+    set(0xA5, &CPU::op_alu_a_r<0xA5>,      "AND A, L");
+    set(0xA6, &CPU::op_alu_a_r<0xA6>,    "AND A, [HL]");
+    set(0xA7, &CPU::op_alu_a_r<0xA7>,      "AND A, A");
+    set(0xA8, &CPU::op_alu_a_r<0xA8>,      "XOR A, B");
+    set(0xA9, &CPU::op_alu_a_r<0xA9>,      "XOR A, C");
+    set(0xAA, &CPU::op_alu_a_r<0xAA>,      "XOR A, D");
+    set(0xAB, &CPU::op_alu_a_r<0xAB>,      "XOR A, E");
+    set(0xAC, &CPU::op_alu_a_r<0xAC>,      "XOR A, H");
+    set(0xAD, &CPU::op_alu_a_r<0xAD>,      "XOR A, L");
+    set(0xAE, &CPU::op_alu_a_r<0xAE>,    "XOR A, [HL]");
+    set(0xAF, &CPU::op_alu_a_r<0xAF>,      "XOR A, A");
 
     // 0xB0 - 0xBF
-    set(0xB0, &CPU::op_or_a_b,       "OR A, B");
-    set(0xB1, &CPU::op_or_a_c,       "OR A, C");
-    set(0xB2, &CPU::op_or_a_d,       "OR A, D");
-    set(0xB3, &CPU::op_or_a_e,       "OR A, E");
-    set(0xB4, &CPU::op_or_a_h,       "OR A, H");
-    set(0xB5, &CPU::op_or_a_l,       "OR A, L");
-    set(0xB6, &CPU::op_or_a_hlm,     "OR A, [HL]");
-    set(0xB7, &CPU::op_or_a_a,       "OR A, A");
-    set(0xB8, &CPU::op_cp_a_b,       "CP A, B");
-    set(0xB9, &CPU::op_cp_a_c,       "CP A, C");
-    set(0xBA, &CPU::op_cp_a_d,       "CP A, D");
-    set(0xBB, &CPU::op_cp_a_e,       "CP A, E");
-    set(0xBC, &CPU::op_cp_a_h,       "CP A, H");
-    set(0xBD, &CPU::op_cp_a_l,       "CP A, L");
-    set(0xBE, &CPU::op_cp_a_hlm,     "CP A, [HL]");
-    set(0xBF, &CPU::op_cp_a_a,       "CP A, A");
+    set(0xB0, &CPU::op_alu_a_r<0xB0>,       "OR A, B");
+    set(0xB1, &CPU::op_alu_a_r<0xB1>,       "OR A, C");
+    set(0xB2, &CPU::op_alu_a_r<0xB2>,       "OR A, D");
+    set(0xB3, &CPU::op_alu_a_r<0xB3>,       "OR A, E");
+    set(0xB4, &CPU::op_alu_a_r<0xB4>,       "OR A, H");
+    set(0xB5, &CPU::op_alu_a_r<0xB5>,       "OR A, L");
+    set(0xB6, &CPU::op_alu_a_r<0xB6>,     "OR A, [HL]");
+    set(0xB7, &CPU::op_alu_a_r<0xB7>,       "OR A, A");
+    set(0xB8, &CPU::op_alu_a_r<0xB8>,       "CP A, B");
+    set(0xB9, &CPU::op_alu_a_r<0xB9>,       "CP A, C");
+    set(0xBA, &CPU::op_alu_a_r<0xBA>,       "CP A, D");
+    set(0xBB, &CPU::op_alu_a_r<0xBB>,       "CP A, E");
+    set(0xBC, &CPU::op_alu_a_r<0xBC>,       "CP A, H");
+    set(0xBD, &CPU::op_alu_a_r<0xBD>,       "CP A, L");
+    set(0xBE, &CPU::op_alu_a_r<0xBE>,     "CP A, [HL]");
+    set(0xBF, &CPU::op_alu_a_r<0xBF>,       "CP A, A");
 
     // 0xC0 - 0xCF
     set(0xC0, &CPU::op_ret_nz,       "RET NZ");
-    set(0xC1, &CPU::op_pop_bc,       "POP BC");
+    set(0xC1, &CPU::op_pop_rr<0xC1>,       "POP BC");
     set(0xC2, &CPU::op_jp_nz_a16,    "JP NZ, a16");
     set(0xC3, &CPU::op_jp_a16,       "JP a16");
     set(0xC4, &CPU::op_call_nz_a16,  "CALL NZ, a16");
-    set(0xC5, &CPU::op_push_bc,      "PUSH BC");
+    set(0xC5, &CPU::op_push_rr<0xC5>,      "PUSH BC");
     set(0xC6, &CPU::op_add_a_n8,     "ADD A, n8");
     set(0xC7, &CPU::op_rst_00,       "RST $00");
     set(0xC8, &CPU::op_ret_z,        "RET Z");
@@ -3141,11 +2508,11 @@ void CPU::init() {
 
     // 0xD0 - 0xDF
     set(0xD0, &CPU::op_ret_nc,       "RET NC");
-    set(0xD1, &CPU::op_pop_de,       "POP DE");
+    set(0xD1, &CPU::op_pop_rr<0xD1>,       "POP DE");
     set(0xD2, &CPU::op_jp_nc_a16,    "JP NC, a16");
     // set(0xD3, &CPU::op_unused_d3, "ILLEGAL (0xD3)");
     set(0xD4, &CPU::op_call_nc_a16,  "CALL NC, a16");
-    set(0xD5, &CPU::op_push_de,      "PUSH DE");
+    set(0xD5, &CPU::op_push_rr<0xD5>,      "PUSH DE");
     set(0xD6, &CPU::op_sub_a_n8,     "SUB A, n8");
     set(0xD7, &CPU::op_rst_10,       "RST $10");
     set(0xD8, &CPU::op_ret_c,        "RET C");
@@ -3159,11 +2526,11 @@ void CPU::init() {
 
     // 0xE0 - 0xEF
     set(0xE0, &CPU::op_ldh_a8m_a,    "LDH [a8], A");
-    set(0xE1, &CPU::op_pop_hl,       "POP HL");
+    set(0xE1, &CPU::op_pop_rr<0xE1>,       "POP HL");
     set(0xE2, &CPU::op_ldh_cm_a,    "LDH [C], A");
     // set(0xE3, &CPU::op_unused_e3,    "ILLEGAL (0xE3)");
     // set(0xE4, &CPU::op_unused_e4,    "ILLEGAL (0xE4)");
-    set(0xE5, &CPU::op_push_hl,      "PUSH HL");
+    set(0xE5, &CPU::op_push_rr<0xE5>,      "PUSH HL");
     set(0xE6, &CPU::op_and_a_n8,     "AND A, n8");
     set(0xE7, &CPU::op_rst_20,       "RST $20");
     set(0xE8, &CPU::op_add_sp_e8,    "ADD SP, e8");
@@ -3177,11 +2544,11 @@ void CPU::init() {
 
     // 0xF0 - 0xFF
     set(0xF0, &CPU::op_ldh_a_a8m,    "LDH A, [a8]");
-    set(0xF1, &CPU::op_pop_af,       "POP AF");
+    set(0xF1, &CPU::op_pop_rr<0xF1>,       "POP AF");
     set(0xF2, &CPU::op_ldh_a_cm,      "LDH A, [C]");
     set(0xF3, &CPU::op_di,           "DI");
     // set(0xF4, &CPU::op_unused_f4,    "ILLEGAL (0xF4)");
-    set(0xF5, &CPU::op_push_af,      "PUSH AF");
+    set(0xF5, &CPU::op_push_rr<0xF5>,      "PUSH AF");
     set(0xF6, &CPU::op_or_a_n8,      "OR A, n8");
     set(0xF7, &CPU::op_rst_30,       "RST $30");
     set(0xF8, &CPU::op_ld_hl_sp_e8,  "LD HL, SP+e8");
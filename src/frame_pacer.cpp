@@ -0,0 +1,66 @@
+#include "frame_pacer.hpp"
+
+#include "config.hpp"
+
+#include <thread>
+
+FramePacer::FramePacer() = default;
+
+void FramePacer::pace(uint64_t cycle) {
+    this->wait_until(cycle);
+
+    const Clock::time_point now = Clock::now();
+    if (!this->report_started_) {
+        this->report_started_ = true;
+        this->report_time_ = now;
+        this->report_cycle_ = cycle;
+    } else if (now - this->report_time_ >= k_report_interval) {
+        const double emulated_seconds = static_cast<double>(cycle - this->report_cycle_) / config::k_cpu_clock_hz;
+        const double real_seconds = std::chrono::duration<double>(now - this->report_time_).count();
+        this->speed_percent_ = 100.0 * emulated_seconds / real_seconds;
+        this->report_ready_ = true;
+        this->report_time_ = now;
+        this->report_cycle_ = cycle;
+    }
+}
+
+void FramePacer::wait_until(uint64_t cycle) {
+    Clock::time_point now = Clock::now();
+    if (this->turbo_) return;
+    if (!this->synced_) {
+        this->resync(now, cycle);
+        return;
+    }
+
+    const std::chrono::duration<double> emulated(static_cast<double>(cycle - this->origin_cycle_) / config::k_cpu_clock_hz);
+    const Clock::time_point deadline = this->origin_time_ + std::chrono::duration_cast<Clock::duration>(emulated);
+    if (now - deadline > k_max_lag) {
+        this->resync(now, cycle);
+        return;
+    }
+
+    if (deadline - now > k_spin_window) {
+        std::this_thread::sleep_for(deadline - now - k_spin_window);
+    }
+    while (now < deadline) {
+        now = Clock::now();
+    }
+}
+
+void FramePacer::set_turbo(bool turbo) {
+    this->turbo_ = turbo;
+    this->synced_ = false;
+}
+
+bool FramePacer::consume_speed_report(double &percent) {
+    if (!this->report_ready_) return false;
+    this->report_ready_ = false;
+    percent = this->speed_percent_;
+    return true;
+}
+
+void FramePacer::resync(Clock::time_point now, uint64_t cycle) {
+    this->origin_time_ = now;
+    this->origin_cycle_ = cycle;
+    this->synced_ = true;
+}
@@ -0,0 +1,69 @@
+#include "frame_skipper.hpp"
+
+#include "config.hpp"
+
+namespace {
+constexpr double k_frame_period = static_cast<double>(config::k_tstates_per_frame) / config::k_cpu_clock_hz;
+} // namespace
+
+void FrameSkipper::set_mode(uint32_t skip) {
+    this->auto_ = skip == k_auto;
+    this->skip_ = this->auto_ ? 0 : skip;
+    this->skipped_in_row_ = 0;
+}
+
+bool FrameSkipper::begin_frame(bool turbo) {
+    const Clock::time_point now = Clock::now();
+    this->frame_start_ = now;
+
+    if (this->auto_ && turbo) {
+        this->drawing_ = std::chrono::duration<double>(now - this->last_drawn_).count() >= k_frame_period;
+    } else {
+        this->drawing_ = this->skipped_in_row_ >= this->skip_;
+    }
+
+    if (this->drawing_) {
+        this->skipped_in_row_ = 0;
+        this->last_drawn_ = now;
+    } else {
+        this->skipped_in_row_ += 1;
+    }
+    return this->drawing_;
+}
+
+void FrameSkipper::end_frame() {
+    if (!this->auto_) return;
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - this->frame_start_).count();
+    if (this->drawing_) {
+        this->drawn_time_ += seconds;
+        this->drawn_frames_ += 1;
+    } else {
+        this->skipped_time_ += seconds;
+        this->skipped_frames_ += 1;
+    }
+    if (this->drawn_frames_ + this->skipped_frames_ >= k_window_frames) this->adjust();
+}
+
+void FrameSkipper::adjust() {
+    if (this->drawn_frames_ > 0) {
+        // A skipped frame costs the emulation alone, a drawn one adds rendering. Until a skipped frame has been
+        // measured, assume rendering is free, which moves straight to the highest ratio if even that is too slow.
+        const double drawn = this->drawn_time_ / this->drawn_frames_;
+        const double skipped = this->skipped_frames_ > 0 ? this->skipped_time_ / this->skipped_frames_ : drawn;
+
+        this->skip_ = k_max_skip;
+        for (uint32_t skip = 0; skip < k_max_skip; ++skip) {
+            const double average = skipped + (drawn - skipped) / (skip + 1);
+            if (average <= k_target_load * k_frame_period) {
+                this->skip_ = skip;
+                break;
+            }
+        }
+    }
+
+    this->drawn_time_ = 0.0;
+    this->skipped_time_ = 0.0;
+    this->drawn_frames_ = 0;
+    this->skipped_frames_ = 0;
+}
@@ -17,11 +17,56 @@
 #include <vector>
 
 GB::GB()
-    : stack(registers.SP, memory), idu(registers, memory), alu(registers), bmi(registers, memory), ppu(memory, screen),
-      cpu(registers, memory, stack, idu, alu, bmi, ppu), timer(registers, memory, cpu.stopped), joypad(memory) {
-    this->memory.attach_joypad(&this->joypad);
+    : mbc(memory, scheduler), block_cache(memory), stack(registers.SP, memory), idu(registers, memory), alu(registers),
+      bmi(registers, memory), ppu(memory, screen, scheduler), cpu(registers, memory, stack, idu, alu, bmi, ppu, block_cache, scheduler),
+      timer(registers, memory, scheduler, cpu.stopped), joypad(memory) {
+    this->memory.attach_mbc(&this->mbc);
+    this->memory.attach_block_cache(&this->block_cache);
+    this->cpu.attach_timer(&this->timer);
 };
 
+void GB::enable_jit(bool lockstep) {
+    if (!Jit::available()) throw std::runtime_error("JIT not available: build with GBEMU_ENABLE_JIT on an x86-64 host");
+
+    this->jit = std::make_unique<Jit>(this->block_cache, !lockstep);
+    this->cpu.attach_jit(this->jit.get(), lockstep);
+}
+
+void GB::set_frame_skip(uint32_t skip) { this->frame_skipper.set_mode(skip); }
+
+void GB::set_battery_file(const std::string &path) { this->battery_file = path; }
+
+void GB::set_splash(bool splash) { this->show_splash = splash; }
+
+void GB::set_run_ahead(uint32_t frames) { this->run_ahead_frames = frames; }
+
+void GB::save_state(SaveState &state) const {
+    this->memory.save_state(state.memory);
+    this->mbc.save_state(state.mbc);
+    state.registers = this->registers;
+    state.scheduler = this->scheduler;
+    this->cpu.save_state(state.cpu);
+    this->ppu.save_state(state.ppu);
+    this->timer.save_state(state.timer);
+    this->joypad.save_state(state.joypad);
+}
+
+void GB::load_state(const SaveState &state) {
+    this->memory.load_state(state.memory);
+    this->mbc.load_state(state.mbc);
+    this->registers = state.registers;
+    this->scheduler = state.scheduler;
+    this->cpu.load_state(state.cpu);
+    this->ppu.load_state(state.ppu);
+    this->timer.load_state(state.timer);
+    this->joypad.load_state(state.joypad);
+}
+
+void GB::set_turbo(bool turbo) {
+    this->turbo_enabled.store(turbo);
+    this->frame_pacer.set_turbo(turbo);
+}
+
 CartridgeInfo GB::read_cartridge_header() {
     std::vector<uint8_t> entry_point = this->memory.read_range(0x0100, 0x0103);
     std::vector<uint8_t> logo = this->memory.read_range(0x0104, 0x0133);
@@ -70,6 +115,7 @@ CartridgeInfo GB::read_cartridge_header() {
                                     .rom_size_kb = 32 * (1 << rom_size_code),
                                     .num_rom_banks = 2 * (1 << rom_size_code),
                                     .ram_size_kb = ram_kb,
+                                    .cartridge_type_code = cartridge_type,
                                     .cartridge_type = this->cartridge_types.at(cartridge_type),
                                     .destination = destination,
                                     .game_version = mask_rom_version,
@@ -79,8 +125,8 @@ CartridgeInfo GB::read_cartridge_header() {
     return cartridge_info;
 }
 
-void GB::boot(std::vector<uint8_t> &rom_buf) {
-    this->memory.load_rom(rom_buf);
+CartridgeInfo GB::load(const RomImage &rom) {
+    this->memory.load_rom(rom);
 
     CartridgeInfo cartridge_info = this->read_cartridge_header();
 
@@ -96,16 +142,43 @@ void GB::boot(std::vector<uint8_t> &rom_buf) {
               << "Header Checksum: " << static_cast<int>(cartridge_info.header_checksum) << '\n'
               << "Global Checksum: " << cartridge_info.global_checksum << '\n';
 
-    if (cartridge_info.rom_size_kb > 32 || cartridge_info.ram_size_kb > 0) {
-        throw std::runtime_error("Unsupported cartridge type or RAM size");
+    this->mbc.configure(cartridge_info.cartridge_type_code, static_cast<size_t>(cartridge_info.ram_size_kb) * 1024);
+
+    return cartridge_info;
+}
+
+void GB::load_battery() {
+    if (!this->mbc.has_battery() || this->battery_file.empty()) return;
+
+    std::ifstream file(this->battery_file, std::ios::binary);
+    if (!file) return; // Nothing saved yet
+    this->mbc.load_battery(file);
+    if constexpr (config::k_debug_mode) {
+        std::cout << "[DEBUG] gb > Loaded cartridge RAM from " << this->battery_file << '\n';
     }
+}
 
-    SDL_Init(SDL_INIT_EVERYTHING);
+void GB::save_battery() {
+    if (!this->mbc.has_battery() || this->battery_file.empty()) return;
+
+    std::ofstream file(this->battery_file, std::ios::binary | std::ios::trunc);
+    this->mbc.save_battery(file);
+    if (!file) throw std::runtime_error("Unable to write save file: " + this->battery_file);
+}
+
+void GB::boot(const RomImage &rom) {
+    this->boot_started = std::chrono::steady_clock::now();
+    CartridgeInfo cartridge_info = this->load(rom);
+    this->load_battery();
+
+    // Only what the frontend uses. Audio, game controllers and haptics are slow to bring up, so they get initialised
+    // (SDL_InitSubSystem) once something needs them.
+    SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS);
 
     // TODO: Setup audio
 
     // clang-format off
-    SDL_Window *window = SDL_CreateWindow(
+    this->window = SDL_CreateWindow(
         config::k_window_title,
         SDL_WINDOWPOS_UNDEFINED,
         SDL_WINDOWPOS_UNDEFINED, 
@@ -115,7 +188,9 @@ void GB::boot(std::vector<uint8_t> &rom_buf) {
     );
     // clang-format on
 
-    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    // Vsync only paces the display thread. FramePacer keeps emulation at the DMG frame rate on its own thread,
+    // whatever the display's refresh rate is.
+    SDL_Renderer *renderer = SDL_CreateRenderer(this->window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
 
     SDL_Texture *texture =
         SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, config::k_screen_width, config::k_screen_height);
@@ -128,37 +203,227 @@ void GB::boot(std::vector<uint8_t> &rom_buf) {
 
     // TODO: Draw keybind instructions with bitmap font
 
-    this->screen.clear();
-    this->screen.draw_logo(cartridge_info.logo);
-    this->screen.present();
-    std::this_thread::sleep_for(std::chrono::seconds(3));
-    this->screen.clear();
+    // The logo stays up until the first emulated frame replaces it; nothing waits for it.
+    if (this->show_splash) {
+        this->screen.clear();
+        this->screen.draw_logo(cartridge_info.logo);
+        this->screen.publish();
+        this->screen.present();
+        this->screen.clear();
+    }
+
+    if constexpr (config::k_debug_mode) {
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - this->boot_started;
+        std::cout << "[DEBUG] gb > Window up " << std::fixed << std::setprecision(1) << elapsed.count() << " ms after boot\n";
+    }
 
     this->registers.PC = config::k_pc_entrypoint;
     this->run();
+    this->save_battery();
 };
 
-void GB::run() {
-    // TODO: Enable saving/loading game state
-    while (true) {
-        // Joypad
-        SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_QUIT) return;
-            joypad.handle_event(event);
-        }
-        joypad.tick();
+void GB::benchmark(const RomImage &rom, uint32_t frames) {
+    this->load(rom);
+    this->registers.PC = config::k_pc_entrypoint;
 
-        const uint32_t t_states_advanced = this->cpu.step();
+    // Headless run: no SDL, no input, no presentation. Only the emulated machine is timed.
+    const uint64_t start_cycle = this->scheduler.now();
+    const uint64_t target_cycle = start_cycle + static_cast<uint64_t>(frames) * config::k_tstates_per_frame;
 
-        this->ppu.tick(t_states_advanced);
-        this->timer.tick(t_states_advanced);
+    const auto start = std::chrono::steady_clock::now();
+    while (this->scheduler.now() < target_cycle) {
+        this->run_until(target_cycle);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const uint64_t t_states = this->scheduler.now() - start_cycle;
+
+    const double seconds = elapsed.count();
+    const double mhz = static_cast<double>(t_states) / seconds / 1e6;
+    const double speed = 100.0 * static_cast<double>(t_states) / seconds / config::k_cpu_clock_hz;
+
+    std::cout << "Benchmark: " << frames << " frames (" << t_states << " T-states) in " << std::fixed << std::setprecision(3) << seconds
+              << " s\n"
+              << "Emulated clock: " << std::setprecision(2) << mhz << " MHz (" << std::setprecision(1) << speed << "% of DMG speed)\n";
+    this->print_block_cache_stats();
+    this->print_jit_stats();
+    this->print_loop_stats(t_states);
+}
+
+void GB::print_loop_stats(uint64_t t_states) const {
+    const uint64_t skipped = this->cpu.get_idle_skipped_cycles();
+    const double share = t_states == 0 ? 0.0 : 100.0 * static_cast<double>(skipped) / static_cast<double>(t_states);
+    std::cout << "Idle loops: " << this->cpu.get_idle_skips() << " skips, " << skipped << " T-states fast-forwarded (" << std::fixed
+              << std::setprecision(1) << share << "%)\n";
+    std::cout << "Bulk loops: " << this->cpu.get_bulk_loops() << " runs covering " << this->cpu.get_bulk_loop_cycles() << " T-states\n";
+}
+
+void GB::print_run_ahead_stats() const {
+    if (this->run_ahead_count == 0) return;
+    const std::chrono::duration<double, std::milli> average = this->run_ahead_time / this->run_ahead_count;
+    std::cout << "Run-ahead: " << this->run_ahead_frames << " frames, " << std::fixed << std::setprecision(3) << average.count()
+              << " ms per frame over " << this->run_ahead_count << " frames\n";
+}
+
+void GB::print_jit_stats() const {
+    if (!this->jit) return;
+    std::cout << "JIT: " << this->jit->get_compiled_blocks() << " blocks compiled, " << this->jit->get_native_runs() << " native runs\n";
+}
 
-        this->cpu.service_interrupts();
+void GB::print_block_cache_stats() const {
+    const uint64_t lookups = this->block_cache.get_lookups();
+    const uint64_t hits = this->block_cache.get_hits();
+    const double hit_rate = lookups == 0 ? 0.0 : 100.0 * static_cast<double>(hits) / static_cast<double>(lookups);
+    const uint64_t ops = this->block_cache.get_executed_ops();
+    const double ops_per_lookup = lookups == 0 ? 0.0 : static_cast<double>(ops) / static_cast<double>(lookups);
+
+    std::cout << "Block cache: " << this->block_cache.get_block_count() << " blocks, " << std::fixed << std::setprecision(2) << hit_rate
+              << "% hit rate (" << hits << "/" << lookups << " lookups), " << std::setprecision(1) << ops_per_lookup << " ops per lookup\n";
+}
+
+void GB::run_until(uint64_t target_cycle) {
+    this->advance(this->cpu.run_until(target_cycle));
+
+    const uint32_t dispatch_cycles = this->cpu.service_interrupts();
+    if (dispatch_cycles != 0) this->advance(dispatch_cycles);
+}
+
+void GB::advance(uint32_t cycles) {
+    this->scheduler.advance(cycles);
+    if (this->ppu.catch_up_due()) this->ppu.catch_up();
+    if (this->timer.catch_up_due()) this->timer.catch_up();
+}
+
+bool GB::handle_events() {
+    // Key events the emulation thread has not had room for are retried first and in order; dropping a key up would
+    // leave the button held.
+    while (!this->pending_input_events.empty() && this->input_events.push(this->pending_input_events.front())) {
+        this->pending_input_events.pop_front();
+    }
+
+    SDL_Event event;
+    while (SDL_PollEvent(&event)) {
+        if (event.type == SDL_QUIT) return false;
+        if (event.type == SDL_KEYDOWN && !event.key.repeat && event.key.keysym.scancode == SDL_SCANCODE_TAB) {
+            this->turbo_enabled.store(!this->turbo_enabled.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            this->update_window_title();
+            continue;
+        }
+        if (event.type != SDL_KEYDOWN && event.type != SDL_KEYUP) continue;
+        if (!this->pending_input_events.empty() || !this->input_events.push(event)) this->pending_input_events.push_back(event);
+    }
+    return true;
+}
+
+void GB::run_frame() {
+    const uint64_t frame_end = this->scheduler.now() + config::k_tstates_per_frame;
+    while (this->scheduler.now() < frame_end) {
+        this->run_until(frame_end);
 
         if (this->ppu.consume_frame_ready()) {
-            this->screen.present();
+            if (this->ppu.frame_drawn()) this->screen.publish();
+            return;
+        }
+    }
+}
+
+void GB::update_window_title() {
+    std::ostringstream title;
+    title << config::k_window_title << " - " << std::fixed << std::setprecision(0) << this->speed_percent.load(std::memory_order_relaxed)
+          << "%";
+    if (this->turbo_enabled.load(std::memory_order_relaxed)) title << " (turbo)";
+    if (this->run_ahead_frames > 0) {
+        const double cost_ms = this->run_ahead_ms.load(std::memory_order_relaxed);
+        title << " - run-ahead " << this->run_ahead_frames << ": " << std::setprecision(2) << cost_ms << " ms/frame";
+    }
+    SDL_SetWindowTitle(this->window, title.str().c_str());
+}
+
+void GB::run_ahead(bool draw) {
+    const auto start = std::chrono::steady_clock::now();
+
+    this->save_state(this->run_ahead_state);
+    for (uint32_t frame = 1; frame <= this->run_ahead_frames; ++frame) {
+        this->ppu.set_skip_frames(frame < this->run_ahead_frames || !draw);
+        this->run_frame();
+    }
+    this->load_state(this->run_ahead_state);
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    this->run_ahead_time += elapsed;
+    this->run_ahead_count += 1;
+    this->run_ahead_interval_time += elapsed;
+    this->run_ahead_interval_count += 1;
+}
+
+void GB::emulate() {
+    try {
+        while (this->running.load(std::memory_order_relaxed)) {
+            SDL_Event event;
+            while (this->input_events.pop(event)) {
+                this->joypad.handle_event(event);
+            }
+            const bool turbo_requested = this->turbo_enabled.load(std::memory_order_relaxed);
+            if (turbo_requested != this->frame_pacer.is_turbo()) this->frame_pacer.set_turbo(turbo_requested);
+
+            const bool draw = this->frame_skipper.begin_frame(turbo_requested);
+            this->ppu.set_skip_frames(!draw || this->run_ahead_frames > 0);
+            this->run_frame();
+            if (this->run_ahead_frames > 0) this->run_ahead(draw);
+            this->frame_skipper.end_frame();
+
+            this->frame_pacer.pace(this->scheduler.now());
+            double speed = 0.0;
+            if (this->frame_pacer.consume_speed_report(speed)) {
+                this->speed_percent.store(speed, std::memory_order_relaxed);
+                if (this->run_ahead_interval_count > 0) {
+                    const std::chrono::duration<double, std::milli> total = this->run_ahead_interval_time;
+                    this->run_ahead_ms.store(total.count() / this->run_ahead_interval_count, std::memory_order_relaxed);
+                    this->run_ahead_interval_time = {};
+                    this->run_ahead_interval_count = 0;
+                }
+                this->title_stale.store(true, std::memory_order_release);
+            }
+        }
+    } catch (...) {
+        this->emulation_error = std::current_exception();
+        this->running.store(false);
+    }
+}
+
+void GB::run() {
+    // TODO: Write save states (see save_state/load_state) to disk
+    this->running.store(true);
+    std::thread emulation(&GB::emulate, this);
+
+    bool first_frame_shown = false;
+
+    while (this->running.load(std::memory_order_relaxed) && this->handle_events()) {
+        if (this->title_stale.exchange(false, std::memory_order_acquire)) this->update_window_title();
+        // Nothing new to show: wait a little instead of spinning (with vsync, presenting already waits).
+        if (!this->screen.present()) {
+            SDL_Delay(1);
+            continue;
         }
+
+        if constexpr (config::k_debug_mode) {
+            if (!first_frame_shown) {
+                const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - this->boot_started;
+                std::cout << "[DEBUG] gb > First frame on screen " << std::fixed << std::setprecision(1) << elapsed.count()
+                          << " ms after boot\n";
+            }
+        }
+        first_frame_shown = true;
+    }
+
+    this->running.store(false);
+    emulation.join();
+    if (this->emulation_error) std::rethrow_exception(this->emulation_error);
+    this->print_run_ahead_stats();
+
+    if constexpr (config::k_debug_mode) {
+        std::cout << "[DEBUG] gb > ";
+        this->print_block_cache_stats();
+        this->print_jit_stats();
     }
 }
 
@@ -10,9 +10,12 @@ void IDU::increment_r8(uint8_t &register_8) {
     uint8_t result = static_cast<uint8_t>(register_8 + 1);
 
     // Flags Z 0 H -
-    this->registers_.set_flag_z(result == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h((register_8 & 0x0F) == 0x0F);
+    if constexpr (config::k_eager_flags) {
+        this->registers_.set_flag_z(result == 0);
+        this->registers_.set_flag_n(false);
+        this->registers_.set_flag_h((register_8 & 0x0F) == 0x0F);
+    }
+    this->registers_.defer_flags(FlagOp::Inc, result);
 
     register_8 = result;
 }
@@ -20,9 +23,12 @@ void IDU::decrement_r8(uint8_t &register_8) {
     uint8_t result = static_cast<uint8_t>(register_8 - 1);
 
     // Flags Z 1 H -
-    this->registers_.set_flag_z(result == 0);
-    this->registers_.set_flag_n(true);
-    this->registers_.set_flag_h((register_8 & 0x0F) == 0x00);
+    if constexpr (config::k_eager_flags) {
+        this->registers_.set_flag_z(result == 0);
+        this->registers_.set_flag_n(true);
+        this->registers_.set_flag_h((register_8 & 0x0F) == 0x00);
+    }
+    this->registers_.defer_flags(FlagOp::Dec, result);
 
     register_8 = result;
 }
@@ -32,9 +38,12 @@ void IDU::increment_mem8(uint16_t address) {
     uint8_t result = static_cast<uint8_t>(value + 1);
 
     // Flags Z 0 H -
-    this->registers_.set_flag_z(result == 0);
-    this->registers_.set_flag_n(false);
-    this->registers_.set_flag_h((value & 0x0F) == 0x0F);
+    if constexpr (config::k_eager_flags) {
+        this->registers_.set_flag_z(result == 0);
+        this->registers_.set_flag_n(false);
+        this->registers_.set_flag_h((value & 0x0F) == 0x0F);
+    }
+    this->registers_.defer_flags(FlagOp::Inc, result);
 
     this->memory_.write_byte(address, result);
 }
@@ -43,9 +52,12 @@ void IDU::decrement_mem8(uint16_t address) {
     uint8_t result = static_cast<uint8_t>(value - 1);
 
     // Flags Z 1 H -
-    this->registers_.set_flag_z(result == 0);
-    this->registers_.set_flag_n(true);
-    this->registers_.set_flag_h((value & 0x0F) == 0x00);
+    if constexpr (config::k_eager_flags) {
+        this->registers_.set_flag_z(result == 0);
+        this->registers_.set_flag_n(true);
+        this->registers_.set_flag_h((value & 0x0F) == 0x00);
+    }
+    this->registers_.defer_flags(FlagOp::Dec, result);
 
     this->memory_.write_byte(address, result);
 }
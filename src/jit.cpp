@@ -0,0 +1,748 @@
+#include "jit.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(GBEMU_ENABLE_JIT) && defined(__x86_64__) && !defined(_WIN32)
+#define GBEMU_JIT_X86_64 1
+#include <sys/mman.h>
+#endif
+
+#if defined(GBEMU_JIT_X86_64)
+namespace {
+// Host registers (x86-64 encoding numbers).
+constexpr uint8_t k_rax = 0;
+constexpr uint8_t k_rcx = 1;
+constexpr uint8_t k_rdx = 2;
+constexpr uint8_t k_rbx = 3; // JitContext *
+constexpr uint8_t k_rbp = 5; // Flag table
+constexpr uint8_t k_rsi = 6;
+constexpr uint8_t k_rdi = 7;
+
+// Guest registers pinned to r8-r15.
+constexpr uint8_t k_guest_a = 8;
+constexpr uint8_t k_guest_f = 9;
+constexpr uint8_t k_guest_b = 10;
+constexpr uint8_t k_guest_c = 11;
+constexpr uint8_t k_guest_d = 12;
+constexpr uint8_t k_guest_e = 13;
+constexpr uint8_t k_guest_h = 14;
+constexpr uint8_t k_guest_l = 15;
+
+// SM83 r8 operand index (0:B 1:C 2:D 3:E 4:H 5:L 6:[HL] 7:A) -> host register.
+constexpr uint8_t k_guest_r8[8] = {k_guest_b, k_guest_c, k_guest_d, k_guest_e, k_guest_h, k_guest_l, 0xFF, k_guest_a};
+
+constexpr uint8_t k_flag_z = 0x80;
+constexpr uint8_t k_flag_n = 0x40;
+constexpr uint8_t k_flag_h = 0x20;
+constexpr uint8_t k_flag_c = 0x10;
+
+// Group-1 ALU opcodes (op r/m8, r8) and their /digit for the imm8 form, indexed like the SM83 ALU block.
+// ADD ADC SUB SBC AND XOR OR CP
+constexpr uint8_t k_alu_rr[8] = {0x00, 0x10, 0x28, 0x18, 0x20, 0x30, 0x08, 0x38};
+constexpr uint8_t k_alu_digit[8] = {0, 2, 5, 3, 4, 6, 1, 7};
+constexpr uint8_t k_digit_or = 1;
+constexpr uint8_t k_digit_and = 4;
+constexpr uint8_t k_digit_xor = 6;
+
+constexpr uint8_t k_jcc_below = 0x82;
+constexpr uint8_t k_jcc_above_equal = 0x83;
+constexpr uint8_t k_jcc_equal = 0x84;
+constexpr uint8_t k_jcc_not_equal = 0x85;
+
+class Emitter {
+  public:
+    std::vector<uint8_t> code;
+
+    void byte(uint8_t value) { this->code.push_back(value); }
+    void bytes(std::initializer_list<uint8_t> values) { this->code.insert(this->code.end(), values); }
+    void imm16(uint16_t value) {
+        this->byte(static_cast<uint8_t>(value));
+        this->byte(static_cast<uint8_t>(value >> 8));
+    }
+    void imm32(uint32_t value) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            this->byte(static_cast<uint8_t>(value >> shift));
+        }
+    }
+
+    // REX is always emitted for byte operations so r8b-r15b and sil/dil never alias AH-BH.
+    void rex(bool wide, uint8_t reg, uint8_t index, uint8_t base) {
+        this->byte(static_cast<uint8_t>(0x40 | (wide ? 0x08 : 0) | ((reg >> 3) << 2) | ((index >> 3) << 1) | (base >> 3)));
+    }
+    void modrm(uint8_t mod, uint8_t reg, uint8_t rm) { this->byte(static_cast<uint8_t>((mod << 6) | ((reg & 7) << 3) | (rm & 7))); }
+
+    // op r/m8(dst), r8(src)
+    void op8_rr(uint8_t opcode, uint8_t dst, uint8_t src) {
+        this->rex(false, src, 0, dst);
+        this->byte(opcode);
+        this->modrm(3, src, dst);
+    }
+    void mov8_rr(uint8_t dst, uint8_t src) { this->op8_rr(0x88, dst, src); }
+    void op8_ri(uint8_t digit, uint8_t dst, uint8_t value) {
+        this->rex(false, 0, 0, dst);
+        this->byte(0x80);
+        this->modrm(3, digit, dst);
+        this->byte(value);
+    }
+    void mov8_ri(uint8_t dst, uint8_t value) {
+        this->rex(false, 0, 0, dst);
+        this->byte(static_cast<uint8_t>(0xB0 + (dst & 7)));
+        this->byte(value);
+    }
+    void unary8(uint8_t digit, uint8_t dst) { // FE /0 inc, FE /1 dec, F6 /2 not
+        this->rex(false, 0, 0, dst);
+        this->byte(digit == 2 ? 0xF6 : 0xFE);
+        this->modrm(3, digit, dst);
+    }
+    void test8_ri(uint8_t dst, uint8_t value) {
+        this->rex(false, 0, 0, dst);
+        this->byte(0xF6);
+        this->modrm(3, 0, dst);
+        this->byte(value);
+    }
+
+    // 8-bit load/store relative to the context pointer.
+    void load8_ctx(uint8_t dst, uint8_t offset) {
+        this->rex(false, dst, 0, k_rbx);
+        this->byte(0x8A);
+        this->modrm(1, dst, k_rbx);
+        this->byte(offset);
+    }
+    void store8_ctx(uint8_t offset, uint8_t src) {
+        this->rex(false, src, 0, k_rbx);
+        this->byte(0x88);
+        this->modrm(1, src, k_rbx);
+        this->byte(offset);
+    }
+    void load64_ctx(uint8_t dst, uint8_t offset) {
+        this->rex(true, dst, 0, k_rbx);
+        this->byte(0x8B);
+        this->modrm(1, dst, k_rbx);
+        this->byte(offset);
+    }
+
+    void movzx32_r8(uint8_t dst, uint8_t src) {
+        this->rex(false, dst, 0, src);
+        this->bytes({0x0F, 0xB6});
+        this->modrm(3, dst, src);
+    }
+    // movzx dst32, byte [base + index]
+    void movzx32_m8(uint8_t dst, uint8_t base, uint8_t index) {
+        this->rex(false, dst, index, base);
+        this->bytes({0x0F, 0xB6});
+        if ((base & 7) == k_rbp) {
+            this->modrm(1, dst, 4);
+            this->byte(static_cast<uint8_t>(((index & 7) << 3) | (base & 7)));
+            this->byte(0);
+        } else {
+            this->modrm(0, dst, 4);
+            this->byte(static_cast<uint8_t>(((index & 7) << 3) | (base & 7)));
+        }
+    }
+    // mov byte [base + index], src8 (base must not be rbp/r13)
+    void store8_m(uint8_t base, uint8_t index, uint8_t src) {
+        this->rex(false, src, index, base);
+        this->byte(0x88);
+        this->modrm(0, src, 4);
+        this->byte(static_cast<uint8_t>(((index & 7) << 3) | (base & 7)));
+    }
+
+    void mov32_rr(uint8_t dst, uint8_t src) {
+        this->rex(false, src, 0, dst);
+        this->byte(0x89);
+        this->modrm(3, src, dst);
+    }
+    void mov32_ri(uint8_t dst, uint32_t value) {
+        this->rex(false, 0, 0, dst);
+        this->byte(static_cast<uint8_t>(0xB8 + (dst & 7)));
+        this->imm32(value);
+    }
+    void alu32_ri(uint8_t digit, uint8_t dst, uint32_t value) { // 81 /digit id
+        this->rex(false, 0, 0, dst);
+        this->byte(0x81);
+        this->modrm(3, digit, dst);
+        this->imm32(value);
+    }
+    void or32_rr(uint8_t dst, uint8_t src) {
+        this->rex(false, src, 0, dst);
+        this->byte(0x09);
+        this->modrm(3, src, dst);
+    }
+    void shift32_ri(uint8_t digit, uint8_t dst, uint8_t amount) { // C1 /4 shl, C1 /5 shr
+        this->rex(false, 0, 0, dst);
+        this->byte(0xC1);
+        this->modrm(3, digit, dst);
+        this->byte(amount);
+    }
+    void cmp32_ctx(uint8_t reg, uint8_t offset) {
+        this->rex(false, reg, 0, k_rbx);
+        this->byte(0x3B);
+        this->modrm(1, reg, k_rbx);
+        this->byte(offset);
+    }
+
+    void push(uint8_t reg) {
+        if (reg >= 8) this->byte(0x41);
+        this->byte(static_cast<uint8_t>(0x50 + (reg & 7)));
+    }
+    void pop(uint8_t reg) {
+        if (reg >= 8) this->byte(0x41);
+        this->byte(static_cast<uint8_t>(0x58 + (reg & 7)));
+    }
+    void call_ctx(uint8_t offset) { this->bytes({0xFF, 0x53, offset}); }
+
+    // Jumps return the offset of their rel32 field for patching.
+    size_t jmp() {
+        this->byte(0xE9);
+        this->imm32(0);
+        return this->code.size() - 4;
+    }
+    size_t jcc(uint8_t condition) {
+        this->bytes({0x0F, condition});
+        this->imm32(0);
+        return this->code.size() - 4;
+    }
+    void bind(size_t rel32_at) { this->bind(rel32_at, this->code.size()); }
+    void bind(size_t rel32_at, size_t target) {
+        const int32_t rel = static_cast<int32_t>(target) - static_cast<int32_t>(rel32_at + 4);
+        std::memcpy(&this->code[rel32_at], &rel, sizeof(rel));
+    }
+};
+
+constexpr uint8_t ctx_offset(size_t offset) { return static_cast<uint8_t>(offset); }
+static_assert(offsetof(JitContext, cpu) < 0x80, "JitContext fields must be reachable with disp8");
+
+const uint8_t k_off_a = ctx_offset(offsetof(JitContext, a));
+const uint8_t k_off_pc = ctx_offset(offsetof(JitContext, pc));
+const uint8_t k_off_stop = ctx_offset(offsetof(JitContext, stop_after_write));
+const uint8_t k_off_wram = ctx_offset(offsetof(JitContext, wram));
+const uint8_t k_off_hram = ctx_offset(offsetof(JitContext, hram));
+const uint8_t k_off_rom = ctx_offset(offsetof(JitContext, rom));
+const uint8_t k_off_rom_limit = ctx_offset(offsetof(JitContext, rom_limit));
+const uint8_t k_off_code_pages = ctx_offset(offsetof(JitContext, code_pages));
+const uint8_t k_off_flag_table = ctx_offset(offsetof(JitContext, flag_table));
+const uint8_t k_off_read = ctx_offset(offsetof(JitContext, read));
+const uint8_t k_off_write = ctx_offset(offsetof(JitContext, write));
+
+// Guest register order in JitContext (a f b c d e h l).
+constexpr uint8_t k_context_order[8] = {k_guest_a, k_guest_f, k_guest_b, k_guest_c, k_guest_d, k_guest_e, k_guest_h, k_guest_l};
+
+class Translator {
+  public:
+    Translator(bool use_hooks) : use_hooks_(use_hooks) {}
+
+    Emitter e;
+
+    void prologue() {
+        for (uint8_t reg : {k_rbx, k_rbp, uint8_t(12), uint8_t(13), uint8_t(14), uint8_t(15)}) {
+            this->e.push(reg);
+        }
+        this->e.bytes({0x48, 0x83, 0xEC, 0x08}); // sub rsp, 8 (16-byte aligned for hook calls)
+        this->e.bytes({0x48, 0x89, 0xFB});       // mov rbx, rdi
+        this->e.load64_ctx(k_rbp, k_off_flag_table);
+        for (uint8_t i = 0; i < 8; ++i) {
+            this->e.load8_ctx(k_context_order[i], static_cast<uint8_t>(k_off_a + i));
+        }
+    }
+
+    void epilogue() {
+        for (size_t at : this->epilogue_jumps_) {
+            this->e.bind(at);
+        }
+        for (uint8_t i = 0; i < 8; ++i) {
+            this->e.store8_ctx(static_cast<uint8_t>(k_off_a + i), k_context_order[i]);
+        }
+        this->e.bytes({0x48, 0x83, 0xC4, 0x08}); // add rsp, 8
+        for (uint8_t reg : {uint8_t(15), uint8_t(14), uint8_t(13), uint8_t(12), k_rbp, k_rbx}) {
+            this->e.pop(reg);
+        }
+        this->e.byte(0xC3);
+    }
+
+    // Leaves the block with PC and the T-states executed so far.
+    void exit(uint16_t pc, uint32_t cycles) {
+        this->e.bytes({0x66, 0xC7, 0x43, k_off_pc});
+        this->e.imm16(pc);
+        this->e.mov32_ri(k_rax, cycles);
+        this->epilogue_jumps_.push_back(this->e.jmp());
+    }
+
+    // Returns false if the instruction is not translated; nothing has been emitted for it in that case.
+    bool translate(const MicroOp &op, uint32_t cycles_before, bool last) {
+        const uint8_t opcode = op.opcode;
+        const uint16_t next_pc = static_cast<uint16_t>(op.pc + op.length);
+        const uint32_t cycles_after = cycles_before + op.cycles;
+        this->current_ = &op;
+        this->cycles_before_ = cycles_before;
+        this->wrote_through_hook_ = false;
+
+        if (opcode >= 0x40 && opcode <= 0x7F && opcode != 0x76) {
+            const uint8_t dst = (opcode >> 3) & 7;
+            const uint8_t src = opcode & 7;
+            if (dst == 6) {
+                this->hl_to_ecx();
+                this->e.mov8_rr(k_rdx, k_guest_r8[src]);
+                this->write_ecx_dl();
+            } else if (src == 6) {
+                this->hl_to_ecx();
+                this->read_ecx_to_dl();
+                this->e.mov8_rr(k_guest_r8[dst], k_rdx);
+            } else if (dst != src) {
+                this->e.mov8_rr(k_guest_r8[dst], k_guest_r8[src]);
+            }
+        } else if (opcode >= 0x80 && opcode <= 0xBF) {
+            const uint8_t src = opcode & 7;
+            if (src == 6) {
+                this->hl_to_ecx();
+                this->read_ecx_to_dl();
+                this->alu_a((opcode >> 3) & 7, k_rdx, false, 0);
+            } else {
+                this->alu_a((opcode >> 3) & 7, k_guest_r8[src], false, 0);
+            }
+        } else if ((opcode & 0xC7) == 0xC6) { // ALU A, n8
+            this->alu_a((opcode >> 3) & 7, 0, true, static_cast<uint8_t>(op.imm));
+        } else if ((opcode & 0xC7) == 0x06) { // LD r, n8
+            const uint8_t dst = (opcode >> 3) & 7;
+            if (dst == 6) {
+                this->hl_to_ecx();
+                this->e.mov8_ri(k_rdx, static_cast<uint8_t>(op.imm));
+                this->write_ecx_dl();
+            } else {
+                this->e.mov8_ri(k_guest_r8[dst], static_cast<uint8_t>(op.imm));
+            }
+        } else if ((opcode & 0xC7) == 0x04 || (opcode & 0xC7) == 0x05) { // INC/DEC r
+            const uint8_t dst = (opcode >> 3) & 7;
+            if (dst == 6) return false;
+            const bool dec = (opcode & 1) != 0;
+            this->e.mov8_rr(k_rdx, k_guest_f);
+            this->e.op8_ri(k_digit_and, k_rdx, k_flag_c);
+            this->e.unary8(dec ? 1 : 0, k_guest_r8[dst]);
+            this->flags_from_host();
+            this->e.op8_ri(k_digit_and, k_guest_f, k_flag_z | k_flag_h);
+            this->e.op8_rr(0x08, k_guest_f, k_rdx); // or f, dl
+            if (dec) this->e.op8_ri(k_digit_or, k_guest_f, k_flag_n);
+        } else {
+            switch (opcode) {
+            case 0x00: // NOP
+                break;
+            case 0x01: // LD rr, n16
+            case 0x11:
+            case 0x21: {
+                const uint8_t pair = static_cast<uint8_t>((opcode >> 4) * 2);
+                this->e.mov8_ri(k_guest_r8[pair], static_cast<uint8_t>(op.imm >> 8));
+                this->e.mov8_ri(k_guest_r8[pair + 1], static_cast<uint8_t>(op.imm));
+                break;
+            }
+            case 0x03: // INC/DEC rr
+            case 0x13:
+            case 0x23:
+            case 0x0B:
+            case 0x1B:
+            case 0x2B: {
+                const uint8_t pair = static_cast<uint8_t>((opcode >> 4) * 2);
+                this->pair_to_ecx(k_guest_r8[pair], k_guest_r8[pair + 1]);
+                this->step_ecx((opcode & 0x08) == 0 ? 1 : -1);
+                this->ecx_to_pair(k_guest_r8[pair], k_guest_r8[pair + 1]);
+                break;
+            }
+            case 0x02: // LD [BC]/[DE], A
+            case 0x12:
+                this->pair_to_ecx(opcode == 0x02 ? k_guest_b : k_guest_d, opcode == 0x02 ? k_guest_c : k_guest_e);
+                this->e.mov8_rr(k_rdx, k_guest_a);
+                this->write_ecx_dl();
+                break;
+            case 0x0A: // LD A, [BC]/[DE]
+            case 0x1A:
+                this->pair_to_ecx(opcode == 0x0A ? k_guest_b : k_guest_d, opcode == 0x0A ? k_guest_c : k_guest_e);
+                this->read_ecx_to_dl();
+                this->e.mov8_rr(k_guest_a, k_rdx);
+                break;
+            case 0x22: // LD [HL+]/[HL-], A
+            case 0x32:
+                this->hl_to_ecx();
+                this->e.mov8_rr(k_rdx, k_guest_a);
+                this->write_ecx_dl();
+                this->hl_to_ecx();
+                this->step_ecx(opcode == 0x22 ? 1 : -1);
+                this->ecx_to_pair(k_guest_h, k_guest_l);
+                break;
+            case 0x2A: // LD A, [HL+]/[HL-]
+            case 0x3A:
+                this->hl_to_ecx();
+                this->read_ecx_to_dl();
+                this->e.mov8_rr(k_guest_a, k_rdx);
+                this->hl_to_ecx();
+                this->step_ecx(opcode == 0x2A ? 1 : -1);
+                this->ecx_to_pair(k_guest_h, k_guest_l);
+                break;
+            case 0x2F: // CPL
+                this->e.unary8(2, k_guest_a);
+                this->e.op8_ri(k_digit_or, k_guest_f, k_flag_n | k_flag_h);
+                break;
+            case 0x37: // SCF
+                this->e.op8_ri(k_digit_and, k_guest_f, k_flag_z);
+                this->e.op8_ri(k_digit_or, k_guest_f, k_flag_c);
+                break;
+            case 0x3F: // CCF
+                this->e.op8_ri(k_digit_and, k_guest_f, k_flag_z | k_flag_c);
+                this->e.op8_ri(k_digit_xor, k_guest_f, k_flag_c);
+                break;
+            case 0xE0: // LDH [n8], A
+            case 0xEA: // LD [a16], A
+            case 0xE2: // LDH [C], A
+                this->address_to_ecx(opcode, op.imm);
+                this->e.mov8_rr(k_rdx, k_guest_a);
+                this->write_ecx_dl();
+                break;
+            case 0xF0: // LDH A, [n8]
+            case 0xFA: // LD A, [a16]
+            case 0xF2: // LDH A, [C]
+                this->address_to_ecx(opcode, op.imm);
+                this->read_ecx_to_dl();
+                this->e.mov8_rr(k_guest_a, k_rdx);
+                break;
+            case 0x18: { // JR e8
+                const uint16_t target = static_cast<uint16_t>(next_pc + static_cast<int8_t>(op.imm));
+                this->exit(target, cycles_before + 12);
+                this->max_cycles_ = cycles_before + 12;
+                return true;
+            }
+            case 0xC3: // JP a16
+                this->exit(op.imm, cycles_before + 16);
+                this->max_cycles_ = cycles_before + 16;
+                return true;
+            case 0x20: // JR cc, e8
+            case 0x28:
+            case 0x30:
+            case 0x38: {
+                const uint16_t target = static_cast<uint16_t>(next_pc + static_cast<int8_t>(op.imm));
+                this->conditional_exit((opcode >> 3) & 3, target, cycles_before + 12, next_pc, cycles_after);
+                this->max_cycles_ = cycles_before + 12;
+                return true;
+            }
+            case 0xC2: // JP cc, a16
+            case 0xCA:
+            case 0xD2:
+            case 0xDA:
+                this->conditional_exit((opcode >> 3) & 3, op.imm, cycles_before + 16, next_pc, cycles_after);
+                this->max_cycles_ = cycles_before + 16;
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        if (this->wrote_through_hook_) {
+            // A hooked write may have changed IO state the cycle budget was based on.
+            this->e.bytes({0x80, 0x7B, k_off_stop, 0x00}); // cmp byte [rbx+stop], 0
+            const size_t skip = this->e.jcc(k_jcc_equal);
+            this->exit(next_pc, cycles_after);
+            this->e.bind(skip);
+        }
+        this->max_cycles_ = cycles_after;
+        if (last) this->exit(next_pc, cycles_after);
+        return true;
+    }
+
+    uint32_t max_cycles() const { return this->max_cycles_; }
+
+  private:
+    bool use_hooks_;
+    const MicroOp *current_ = nullptr;
+    uint32_t cycles_before_ = 0;
+    uint32_t max_cycles_ = 0;
+    bool wrote_through_hook_ = false;
+    std::vector<size_t> epilogue_jumps_;
+
+    // r9b = table[AH] after LAHF: Z/H/C from the host flags, N cleared.
+    void flags_from_host() {
+        this->e.byte(0x9F);                     // lahf
+        this->e.bytes({0x0F, 0xB6, 0xC4});      // movzx eax, ah
+        this->e.movzx32_m8(k_guest_f, k_rbp, k_rax);
+    }
+
+    void alu_a(uint8_t operation, uint8_t src, bool immediate, uint8_t value) {
+        if (operation == 1 || operation == 3) {
+            this->e.bytes({0x41, 0x0F, 0xBA, 0xE1, 0x04}); // bt r9d, 4 (guest C -> host CF)
+        }
+        if (immediate) {
+            this->e.op8_ri(k_alu_digit[operation], k_guest_a, value);
+        } else {
+            this->e.op8_rr(k_alu_rr[operation], k_guest_a, src);
+        }
+        this->flags_from_host();
+
+        switch (operation) {
+        case 2: // SUB, SBC, CP
+        case 3:
+        case 7:
+            this->e.op8_ri(k_digit_or, k_guest_f, k_flag_n);
+            break;
+        case 4: // AND
+            this->e.op8_ri(k_digit_and, k_guest_f, k_flag_z);
+            this->e.op8_ri(k_digit_or, k_guest_f, k_flag_h);
+            break;
+        case 5: // XOR, OR
+        case 6:
+            this->e.op8_ri(k_digit_and, k_guest_f, k_flag_z);
+            break;
+        default:
+            break;
+        }
+    }
+
+    void conditional_exit(uint8_t condition, uint16_t taken_pc, uint32_t taken_cycles, uint16_t fall_pc, uint32_t fall_cycles) {
+        // 0:NZ 1:Z 2:NC 3:C
+        const uint8_t mask = condition < 2 ? k_flag_z : k_flag_c;
+        const bool want_set = (condition & 1) != 0;
+        this->e.test8_ri(k_guest_f, mask);
+        const size_t taken = this->e.jcc(want_set ? k_jcc_not_equal : k_jcc_equal);
+        this->exit(fall_pc, fall_cycles);
+        this->e.bind(taken);
+        this->exit(taken_pc, taken_cycles);
+    }
+
+    void pair_to_ecx(uint8_t high, uint8_t low) {
+        this->e.movzx32_r8(k_rcx, high);
+        this->e.shift32_ri(4, k_rcx, 8);
+        this->e.movzx32_r8(k_rax, low);
+        this->e.or32_rr(k_rcx, k_rax);
+    }
+    void hl_to_ecx() { this->pair_to_ecx(k_guest_h, k_guest_l); }
+    void ecx_to_pair(uint8_t high, uint8_t low) {
+        this->e.mov8_rr(low, k_rcx);
+        this->e.mov32_rr(k_rax, k_rcx);
+        this->e.shift32_ri(5, k_rax, 8);
+        this->e.mov8_rr(high, k_rax);
+    }
+    void step_ecx(int delta) {
+        this->e.alu32_ri(0, k_rcx, static_cast<uint32_t>(delta)); // add ecx, delta
+        this->e.alu32_ri(4, k_rcx, 0xFFFF);                        // and ecx, 0xFFFF
+    }
+    void address_to_ecx(uint8_t opcode, uint16_t imm) {
+        if (opcode == 0xE2 || opcode == 0xF2) {
+            this->e.movzx32_r8(k_rcx, k_guest_c);
+            this->e.alu32_ri(1, k_rcx, 0xFF00); // or ecx, 0xFF00
+        } else if (opcode == 0xE0 || opcode == 0xF0) {
+            this->e.mov32_ri(k_rcx, 0xFF00U | (imm & 0xFF));
+        } else {
+            this->e.mov32_ri(k_rcx, imm);
+        }
+    }
+
+    // eax = ecx - start; jae <returned> when ecx is outside [start, start + size).
+    size_t range_check(uint32_t start, uint32_t size) {
+        this->e.mov32_rr(k_rax, k_rcx);
+        this->e.alu32_ri(5, k_rax, start); // sub eax, start
+        this->e.alu32_ri(7, k_rax, size);  // cmp eax, size
+        return this->e.jcc(k_jcc_above_equal);
+    }
+
+    void save_guest_scratch() {
+        for (uint8_t reg = 8; reg <= 11; ++reg) {
+            this->e.push(reg);
+        }
+    }
+    void restore_guest_scratch() {
+        for (uint8_t reg = 11; reg >= 8; --reg) {
+            this->e.pop(reg);
+        }
+    }
+
+    void read_ecx_to_dl() {
+        std::vector<size_t> done;
+
+        const size_t not_wram = this->range_check(0xC000, 0x2000);
+        this->e.load64_ctx(k_rdx, k_off_wram);
+        this->e.movzx32_m8(k_rdx, k_rdx, k_rax);
+        done.push_back(this->e.jmp());
+
+        this->e.bind(not_wram);
+        const size_t not_hram = this->range_check(0xFF80, 0x7F);
+        this->e.load64_ctx(k_rdx, k_off_hram);
+        this->e.movzx32_m8(k_rdx, k_rdx, k_rax);
+        done.push_back(this->e.jmp());
+
+        this->e.bind(not_hram);
+        this->e.cmp32_ctx(k_rcx, k_off_rom_limit);
+        const size_t not_rom = this->e.jcc(k_jcc_above_equal);
+        this->e.load64_ctx(k_rdx, k_off_rom);
+        this->e.movzx32_m8(k_rdx, k_rdx, k_rcx);
+        done.push_back(this->e.jmp());
+
+        this->e.bind(not_rom);
+        if (this->use_hooks_) {
+            this->save_guest_scratch();
+            this->e.bytes({0x48, 0x89, 0xDF}); // mov rdi, rbx
+            this->e.mov32_rr(k_rsi, k_rcx);
+            this->e.mov32_ri(k_rdx, this->cycles_before_);
+            this->e.call_ctx(k_off_read);
+            this->e.movzx32_r8(k_rdx, k_rax);
+            this->restore_guest_scratch();
+        } else {
+            this->exit(this->current_->pc, this->cycles_before_);
+        }
+
+        for (size_t at : done) {
+            this->e.bind(at);
+        }
+    }
+
+    void write_ecx_dl() {
+        std::vector<size_t> done;
+        std::vector<size_t> slow;
+
+        // Writes to pages holding cached code go through Memory so the block cache sees them.
+        auto store_unless_code = [&](uint8_t base_offset) {
+            this->e.mov32_rr(k_rsi, k_rcx);
+            this->e.shift32_ri(5, k_rsi, 6);
+            this->e.load64_ctx(k_rdi, k_off_code_pages);
+            this->e.bytes({0x80, 0x3C, 0x37, 0x00}); // cmp byte [rdi+rsi], 0
+            slow.push_back(this->e.jcc(k_jcc_not_equal));
+            this->e.load64_ctx(k_rdi, base_offset);
+            this->e.store8_m(k_rdi, k_rax, k_rdx);
+            done.push_back(this->e.jmp());
+        };
+
+        const size_t not_wram = this->range_check(0xC000, 0x2000);
+        store_unless_code(k_off_wram);
+
+        this->e.bind(not_wram);
+        slow.push_back(this->range_check(0xFF80, 0x7F));
+        store_unless_code(k_off_hram);
+
+        for (size_t at : slow) {
+            this->e.bind(at);
+        }
+        if (this->use_hooks_) {
+            this->save_guest_scratch();
+            this->e.bytes({0x48, 0x89, 0xDF}); // mov rdi, rbx
+            this->e.mov32_rr(k_rsi, k_rcx);
+            this->e.movzx32_r8(k_rdx, k_rdx);
+            this->e.mov32_ri(k_rcx, this->cycles_before_);
+            this->e.call_ctx(k_off_write);
+            this->restore_guest_scratch();
+            this->wrote_through_hook_ = true;
+        } else {
+            this->exit(this->current_->pc, this->cycles_before_);
+        }
+
+        for (size_t at : done) {
+            this->e.bind(at);
+        }
+    }
+};
+
+constexpr size_t k_chunk_size = 1 << 20;
+} // namespace
+#endif
+
+Jit::Jit(BlockCache &block_cache, bool use_hooks) : block_cache_(block_cache), use_hooks_(use_hooks) {
+    for (size_t ah = 0; ah < this->flag_table_.size(); ++ah) {
+        uint8_t flags = 0;
+        if (ah & 0x40) flags |= 0x80; // ZF -> Z
+        if (ah & 0x10) flags |= 0x20; // AF -> H
+        if (ah & 0x01) flags |= 0x10; // CF -> C
+        this->flag_table_[ah] = flags;
+    }
+}
+
+Jit::~Jit() {
+#if defined(GBEMU_JIT_X86_64)
+    for (const auto &[chunk, size] : this->code_chunks_) {
+        munmap(chunk, size);
+    }
+#endif
+}
+
+bool Jit::available() {
+#if defined(GBEMU_JIT_X86_64)
+    return true;
+#else
+    return false;
+#endif
+}
+
+const JitBlock *Jit::lookup(uint16_t pc, uint16_t bank) {
+    if (pc > k_rom_end) return nullptr;
+
+    JitBlock *block = this->by_pc_[pc];
+    if (block == nullptr || block->bank != bank) {
+        const uint32_t key = (static_cast<uint32_t>(bank) << 16) | pc;
+        block = &this->blocks_.try_emplace(key, JitBlock{bank, 0, nullptr, 0, false}).first->second;
+        this->by_pc_[pc] = block;
+    }
+
+    if (block->fn != nullptr) return block;
+    if (block->tried) return nullptr;
+    if (++block->executions < k_hot_threshold) return nullptr;
+
+    block->tried = true;
+    const Block *decoded = this->block_cache_.lookup(pc);
+    if (decoded == nullptr) return nullptr;
+    block->fn = this->compile(*decoded, block->max_cycles);
+    return block->fn != nullptr ? block : nullptr;
+}
+
+JitBlockFn Jit::compile(const Block &block, uint32_t &max_cycles) {
+#if defined(GBEMU_JIT_X86_64)
+    Translator translator(this->use_hooks_);
+    translator.prologue();
+
+    uint32_t cycles = 0;
+    size_t translated = 0;
+    for (size_t i = 0; i < block.ops.size(); ++i) {
+        const MicroOp &op = block.ops[i];
+        if (!translator.translate(op, cycles, i + 1 == block.ops.size())) break;
+        cycles += op.cycles;
+        translated += 1;
+    }
+    // A one-instruction prefix is not worth the entry/exit cost.
+    if (translated < 2) return nullptr;
+    if (translated < block.ops.size()) {
+        translator.exit(block.ops[translated].pc, cycles);
+    }
+    translator.epilogue();
+    max_cycles = translator.max_cycles();
+
+    const std::vector<uint8_t> &code = translator.e.code;
+    uint8_t *target = this->allocate_code(code.size());
+    if (target == nullptr) return nullptr;
+
+    uint8_t *chunk = this->code_chunks_.back().first;
+    mprotect(chunk, k_chunk_size, PROT_READ | PROT_WRITE);
+    std::memcpy(target, code.data(), code.size());
+    mprotect(chunk, k_chunk_size, PROT_READ | PROT_EXEC);
+
+    this->compiled_blocks_ += 1;
+    return reinterpret_cast<JitBlockFn>(target);
+#else
+    (void)block;
+    (void)max_cycles;
+    return nullptr;
+#endif
+}
+
+uint8_t *Jit::allocate_code(size_t size) {
+#if defined(GBEMU_JIT_X86_64)
+    if (size > k_chunk_size) return nullptr;
+    if (this->code_chunks_.empty() || this->chunk_used_ + size > k_chunk_size) {
+        void *chunk = mmap(nullptr, k_chunk_size, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (chunk == MAP_FAILED) throw std::runtime_error("JIT: unable to map code memory");
+        this->code_chunks_.emplace_back(static_cast<uint8_t *>(chunk), k_chunk_size);
+        this->chunk_used_ = 0;
+    }
+    uint8_t *target = this->code_chunks_.back().first + this->chunk_used_;
+    this->chunk_used_ += (size + 15) & ~static_cast<size_t>(15);
+    return target;
+#else
+    (void)size;
+    return nullptr;
+#endif
+}
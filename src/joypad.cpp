@@ -4,7 +4,20 @@
 
 #include <iostream>
 
-Joypad::Joypad(Memory &memory) : memory_(memory) {}
+Joypad::Joypad(Memory &memory) : memory_(memory) {
+    const Memory::IoHandler handler = {
+        .owner = this,
+        .read = [](void *joypad, uint16_t) { return static_cast<Joypad *>(joypad)->get_joyp(); },
+        .write = [](void *joypad, uint16_t, uint8_t value) { static_cast<Joypad *>(joypad)->set_joyp(value); }};
+    this->memory_.set_io_handler(0xFF00, handler);
+}
+
+void Joypad::save_state(State &state) const { state = {.select_bits = this->select_bits_, .low_nibble = this->low_nibble_}; }
+
+void Joypad::load_state(const State &state) {
+    this->select_bits_ = state.select_bits;
+    this->low_nibble_ = state.low_nibble;
+}
 
 void Joypad::handle_event(const SDL_Event &event) {
     if (event.type == SDL_KEYDOWN && !event.key.repeat) {
@@ -56,6 +69,8 @@ void Joypad::set_key_(SDL_Scancode sc, bool pressed) {
         break;
     }
 
+    if (handled) this->update_lines_();
+
     if constexpr (config::k_debug_mode) {
         if (handled) {
             std::cout << "[DEBUG] joypad > [joypad] " << (pressed ? "down " : "up   ") << gb_btn << " (scancode=" << static_cast<int>(sc)
@@ -66,6 +81,7 @@ void Joypad::set_key_(SDL_Scancode sc, bool pressed) {
 
 void Joypad::set_joyp(uint8_t value) {
     this->select_bits_ = value & 0x30; // only P14/P15 writable
+    this->update_lines_();
 }
 
 uint8_t Joypad::get_low_nibble_() const {
@@ -90,19 +106,19 @@ uint8_t Joypad::get_low_nibble_() const {
     return low;
 }
 
-uint8_t Joypad::compose_joyp_() const { return static_cast<uint8_t>(0xC0 | this->select_bits_ | this->get_low_nibble_()); }
+uint8_t Joypad::compose_joyp_() const { return static_cast<uint8_t>(0xC0 | this->select_bits_ | this->low_nibble_); }
 
 uint8_t Joypad::get_joyp() const { return this->compose_joyp_(); }
 
-void Joypad::tick() {
+void Joypad::update_lines_() {
     const uint8_t low = this->get_low_nibble_();
 
     // Joypad interrupt on 1->0 transition of selected lines
-    const uint8_t falling = static_cast<uint8_t>(this->prev_low_nibble_ & ~low);
+    const uint8_t falling = static_cast<uint8_t>(this->low_nibble_ & ~low);
     if (falling != 0) {
         uint8_t iflags = this->memory_.get_if();
         this->memory_.set_if(static_cast<uint8_t>(iflags | 0x10)); // IF bit4
     }
 
-    this->prev_low_nibble_ = low;
+    this->low_nibble_ = low;
 }
@@ -1,18 +1,13 @@
 #include "config.hpp"
 #include "gb.hpp"
+#include "rom_image.hpp"
 
+#include <chrono>
 #include <cstring>
-#include <fstream>
+#include <filesystem>
+#include <iomanip>
 #include <iostream>
-#include <iterator>
-#include <vector>
-
-std::vector<uint8_t> read_file(const std::string &filename) {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file) throw std::runtime_error("Unable to open file: " + filename);
-
-    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
-}
+#include <string>
 
 int main(int argc, char **argv) {
     if (argc < 2) {
@@ -24,10 +19,57 @@ int main(int argc, char **argv) {
     }
 
     const char *rom_filename = argv[1];
-    std::vector<uint8_t> rom_buf = read_file(rom_filename);
+
+    uint32_t bench_frames = 0;
+    bool jit = false;
+    bool jit_lockstep = false;
+    bool turbo = false;
+    bool splash = true;
+    uint32_t frame_skip = 0;
+    uint32_t run_ahead = 0;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--bench" && i + 1 < argc) {
+            bench_frames = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--jit") {
+            jit = true;
+        } else if (arg == "--jit-lockstep") {
+            jit = true;
+            jit_lockstep = true;
+        } else if (arg == "--no-splash") {
+            splash = false;
+        } else if (arg == "--turbo") {
+            turbo = true;
+        } else if (arg == "--run-ahead" && i + 1 < argc) {
+            run_ahead = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--frameskip" && i + 1 < argc) {
+            const std::string value = argv[++i];
+            frame_skip = value == "auto" ? FrameSkipper::k_auto : static_cast<uint32_t>(std::stoul(value));
+        } else {
+            throw std::runtime_error("Unknown argument: " + arg);
+        }
+    }
+
+    const auto read_started = std::chrono::steady_clock::now();
+    const RomImage rom(rom_filename);
+    if constexpr (config::k_debug_mode) {
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - read_started;
+        std::cout << "[DEBUG] main > " << (rom.mapped() ? "Mapped " : "Read ") << rom.size() << " byte ROM in " << std::fixed
+                  << std::setprecision(2) << elapsed.count() << " ms\n";
+    }
 
     GB gb;
-    gb.boot(rom_buf);
+    if (jit) gb.enable_jit(jit_lockstep);
+    gb.set_battery_file(std::filesystem::path(rom_filename).replace_extension(".sav").string());
+    gb.set_splash(splash);
+    gb.set_turbo(turbo);
+    gb.set_frame_skip(frame_skip);
+    gb.set_run_ahead(run_ahead);
+    if (bench_frames > 0) {
+        gb.benchmark(rom, bench_frames);
+        return 0;
+    }
+    gb.boot(rom);
 
     return 0;
 }
@@ -0,0 +1,342 @@
+#include "mbc.hpp"
+#include "config.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+constexpr uint16_t k_eram_start = 0xA000;
+constexpr size_t k_ram_bank_size = 0x2000;
+constexpr size_t k_mbc2_ram_size = 0x0200; // 512 x 4 bits, mirrored across 0xA000-0xBFFF
+
+constexpr uint8_t k_rtc_first_register = 0x08; // Seconds, minutes, hours, day low, day high
+constexpr uint8_t k_rtc_last_register = 0x0C;
+constexpr uint64_t k_seconds_per_day = 24 * 60 * 60;
+constexpr uint64_t k_rtc_days = 512;
+constexpr size_t k_rtc_footer_size = 48; // 10 little-endian 32-bit registers and a 64-bit Unix time
+
+uint64_t unix_time() {
+    const auto since_epoch = std::chrono::system_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(since_epoch).count());
+}
+} // namespace
+
+Mbc::Mbc(Memory &memory, Scheduler &scheduler) : memory_(memory), scheduler_(scheduler) {}
+
+void Mbc::configure(uint8_t cartridge_type, size_t ram_size) {
+    switch (cartridge_type) {
+    case 0x00: // ROM ONLY
+    case 0x08: // ROM+RAM
+    case 0x09: // ROM+RAM+BATTERY
+        this->kind_ = Kind::None;
+        break;
+    case 0x01: // MBC1
+    case 0x02: // MBC1+RAM
+    case 0x03: // MBC1+RAM+BATTERY
+        this->kind_ = Kind::Mbc1;
+        break;
+    case 0x05: // MBC2
+    case 0x06: // MBC2+BATTERY
+        this->kind_ = Kind::Mbc2;
+        ram_size = k_mbc2_ram_size; // Built in, the header declares none
+        break;
+    case 0x0F: // MBC3+TIMER+BATTERY
+    case 0x10: // MBC3+TIMER+RAM+BATTERY
+    case 0x11: // MBC3
+    case 0x12: // MBC3+RAM
+    case 0x13: // MBC3+RAM+BATTERY
+        this->kind_ = Kind::Mbc3;
+        break;
+    case 0x19: // MBC5
+    case 0x1A: // MBC5+RAM
+    case 0x1B: // MBC5+RAM+BATTERY
+    case 0x1C: // MBC5+RUMBLE
+    case 0x1D: // MBC5+RUMBLE+RAM
+    case 0x1E: // MBC5+RUMBLE+RAM+BATTERY
+        this->kind_ = Kind::Mbc5;
+        break;
+    default: {
+        std::stringstream ss;
+        ss << "Unsupported cartridge type: 0x" << std::uppercase << std::hex << std::setw(2) << std::setfill('0')
+           << static_cast<int>(cartridge_type);
+        throw std::runtime_error(ss.str());
+    }
+    }
+
+    switch (cartridge_type) {
+    case 0x03:
+    case 0x06:
+    case 0x09:
+    case 0x0F:
+    case 0x10:
+    case 0x13:
+    case 0x1B:
+    case 0x1E:
+        this->battery_ = true;
+        break;
+    default:
+        this->battery_ = false;
+        break;
+    }
+    this->rtc_ = cartridge_type == 0x0F || cartridge_type == 0x10;
+    this->rumble_ = cartridge_type >= 0x1C && cartridge_type <= 0x1E;
+
+    this->ram_.assign(ram_size, 0);
+    this->ram_enabled_ = this->kind_ == Kind::None; // Without a controller the RAM is always there
+    this->bank1_ = 1;
+    this->bank2_ = 0;
+    this->advanced_banking_ = false;
+    this->rtc_seconds_ = 0;
+    this->rtc_synced_cycle_ = this->scheduler_.now();
+    this->rtc_halted_cycles_ = 0;
+    this->rtc_halted_ = false;
+    this->rtc_carry_ = false;
+    this->rtc_latch_armed_ = false;
+    this->rtc_latched_ = {};
+    this->remap();
+}
+
+void Mbc::save_state(State &state) const {
+    state.ram = this->ram_;
+    state.ram_enabled = this->ram_enabled_;
+    state.bank1 = this->bank1_;
+    state.bank2 = this->bank2_;
+    state.advanced_banking = this->advanced_banking_;
+    state.rtc_seconds = this->rtc_seconds_;
+    state.rtc_synced_cycle = this->rtc_synced_cycle_;
+    state.rtc_halted_cycles = this->rtc_halted_cycles_;
+    state.rtc_halted = this->rtc_halted_;
+    state.rtc_carry = this->rtc_carry_;
+    state.rtc_latch_armed = this->rtc_latch_armed_;
+    state.rtc_latched = this->rtc_latched_;
+}
+
+void Mbc::load_state(const State &state) {
+    this->ram_ = state.ram;
+    this->ram_enabled_ = state.ram_enabled;
+    this->bank1_ = state.bank1;
+    this->bank2_ = state.bank2;
+    this->advanced_banking_ = state.advanced_banking;
+    this->rtc_seconds_ = state.rtc_seconds;
+    this->rtc_synced_cycle_ = state.rtc_synced_cycle;
+    this->rtc_halted_cycles_ = state.rtc_halted_cycles;
+    this->rtc_halted_ = state.rtc_halted;
+    this->rtc_carry_ = state.rtc_carry;
+    this->rtc_latch_armed_ = state.rtc_latch_armed;
+    this->rtc_latched_ = state.rtc_latched;
+    this->remap();
+}
+
+void Mbc::write_register(uint16_t address, uint8_t value) {
+    switch (this->kind_) {
+    case Kind::Mbc1:
+        if (address < 0x2000) {
+            this->ram_enabled_ = (value & 0x0F) == 0x0A;
+        } else if (address < 0x4000) {
+            this->bank1_ = static_cast<uint8_t>(value & 0x1F);
+            if (this->bank1_ == 0) this->bank1_ = 1;
+        } else if (address < 0x6000) {
+            this->bank2_ = static_cast<uint8_t>(value & 0x03);
+        } else {
+            this->advanced_banking_ = (value & 0x01) != 0;
+        }
+        break;
+    case Kind::Mbc2:
+        if (address >= 0x4000) return;
+        // Address bit 8 tells the two registers apart.
+        if ((address & 0x0100) != 0) {
+            this->bank1_ = static_cast<uint8_t>(value & 0x0F);
+            if (this->bank1_ == 0) this->bank1_ = 1;
+        } else {
+            this->ram_enabled_ = (value & 0x0F) == 0x0A;
+        }
+        break;
+    case Kind::Mbc3:
+        if (address < 0x2000) {
+            this->ram_enabled_ = (value & 0x0F) == 0x0A; // Also enables the clock registers
+        } else if (address < 0x4000) {
+            this->bank1_ = static_cast<uint8_t>(value & 0x7F);
+            if (this->bank1_ == 0) this->bank1_ = 1;
+        } else if (address < 0x6000) {
+            this->bank2_ = value;
+        } else {
+            if (this->rtc_ && this->rtc_latch_armed_ && value == 0x01) {
+                this->rtc_sync();
+                this->rtc_latched_ = this->rtc_registers();
+            }
+            this->rtc_latch_armed_ = value == 0x00;
+            return;
+        }
+        break;
+    case Kind::Mbc5:
+        if (address < 0x2000) {
+            this->ram_enabled_ = (value & 0x0F) == 0x0A;
+        } else if (address < 0x3000) {
+            this->bank1_ = static_cast<uint16_t>((this->bank1_ & 0x100) | value); // Bank 0 can be selected
+        } else if (address < 0x4000) {
+            this->bank1_ = static_cast<uint16_t>((this->bank1_ & 0xFF) | ((value & 0x01) << 8));
+        } else if (address < 0x6000) {
+            this->bank2_ = static_cast<uint8_t>(value & (this->rumble_ ? 0x07 : 0x0F));
+        } else {
+            return;
+        }
+        break;
+    case Kind::None:
+        return;
+    }
+    this->remap();
+}
+
+uint8_t Mbc::read_ram(uint16_t address) const {
+    if (!this->ram_enabled_) return 0xFF;
+    if (this->kind_ == Kind::Mbc3 && this->bank2_ >= k_rtc_first_register) {
+        if (!this->rtc_ || this->bank2_ > k_rtc_last_register) return 0xFF;
+        return this->rtc_latched_[this->bank2_ - k_rtc_first_register];
+    }
+    if (this->ram_.empty()) return 0xFF;
+    const uint8_t value = this->ram_[this->ram_offset(address)];
+    if (this->kind_ == Kind::Mbc2) return static_cast<uint8_t>(0xF0 | value); // Upper nibble is open bus
+    return value;
+}
+
+void Mbc::write_ram(uint16_t address, uint8_t value) {
+    if (!this->ram_enabled_) return;
+    if (this->kind_ == Kind::Mbc3 && this->bank2_ >= k_rtc_first_register) {
+        if (this->rtc_ && this->bank2_ <= k_rtc_last_register) this->rtc_write(this->bank2_, value);
+        return;
+    }
+    if (this->ram_.empty()) return;
+    if (this->kind_ == Kind::Mbc2) value &= 0x0F;
+    this->ram_[this->ram_offset(address)] = value;
+}
+
+size_t Mbc::ram_offset(uint16_t address) const {
+    size_t bank = 0;
+    if (this->kind_ == Kind::Mbc1 && this->advanced_banking_) bank = this->bank2_;
+    if (this->kind_ == Kind::Mbc3) bank = this->bank2_ & 0x03;
+    if (this->kind_ == Kind::Mbc5) bank = this->bank2_;
+    // RAM smaller than the window is mirrored across it.
+    return (bank * k_ram_bank_size + static_cast<size_t>(address - k_eram_start)) % this->ram_.size();
+}
+
+void Mbc::remap() {
+    uint32_t low_bank = 0;
+    uint32_t high_bank = 1;
+    if (this->kind_ == Kind::Mbc1) {
+        high_bank = static_cast<uint32_t>(this->bank2_ << 5) | this->bank1_;
+        if (this->advanced_banking_) low_bank = static_cast<uint32_t>(this->bank2_ << 5);
+    } else if (this->kind_ != Kind::None) {
+        high_bank = this->bank1_;
+    }
+    this->memory_.map_rom(low_bank, high_bank);
+
+    // Only a whole enabled bank of plain RAM can be mapped directly.
+    const bool clock_selected = this->kind_ == Kind::Mbc3 && this->bank2_ >= k_rtc_first_register;
+    uint8_t *ram_bank = nullptr;
+    if (this->ram_enabled_ && this->kind_ != Kind::Mbc2 && !clock_selected && this->ram_.size() >= k_ram_bank_size) {
+        ram_bank = &this->ram_[this->ram_offset(k_eram_start)];
+    }
+    this->memory_.map_eram(ram_bank);
+}
+
+void Mbc::rtc_sync() {
+    const uint64_t now = this->scheduler_.now();
+    if (this->rtc_halted_) return;
+
+    const uint64_t seconds = (now - this->rtc_synced_cycle_) / config::k_cpu_clock_hz;
+    this->rtc_add_seconds(seconds);
+    this->rtc_synced_cycle_ += seconds * config::k_cpu_clock_hz;
+}
+
+void Mbc::rtc_add_seconds(uint64_t seconds) {
+    constexpr uint64_t wrap = k_rtc_days * k_seconds_per_day;
+    this->rtc_seconds_ += seconds;
+    if (this->rtc_seconds_ >= wrap) {
+        this->rtc_carry_ = true;
+        this->rtc_seconds_ %= wrap;
+    }
+}
+
+std::array<uint8_t, 5> Mbc::rtc_registers() const {
+    const uint64_t days = this->rtc_seconds_ / k_seconds_per_day;
+    const uint64_t day_seconds = this->rtc_seconds_ % k_seconds_per_day;
+    return {static_cast<uint8_t>(day_seconds % 60),
+            static_cast<uint8_t>(day_seconds / 60 % 60),
+            static_cast<uint8_t>(day_seconds / 3600),
+            static_cast<uint8_t>(days & 0xFF),
+            static_cast<uint8_t>(((days >> 8) & 0x01) | (this->rtc_halted_ ? 0x40 : 0x00) | (this->rtc_carry_ ? 0x80 : 0x00))};
+}
+
+void Mbc::rtc_write(uint8_t select, uint8_t value) {
+    this->rtc_sync();
+    std::array<uint8_t, 5> registers = this->rtc_registers();
+    registers[select - k_rtc_first_register] = value;
+
+    const uint64_t now = this->scheduler_.now();
+    // Writing the seconds restarts the second in progress.
+    if (select == k_rtc_first_register) {
+        this->rtc_synced_cycle_ = now;
+        this->rtc_halted_cycles_ = 0;
+    }
+
+    const bool halt = (registers[4] & 0x40) != 0;
+    if (halt && !this->rtc_halted_) {
+        this->rtc_halted_cycles_ = static_cast<uint32_t>(now - this->rtc_synced_cycle_);
+    } else if (!halt && this->rtc_halted_) {
+        this->rtc_synced_cycle_ = now - this->rtc_halted_cycles_;
+    }
+    this->rtc_halted_ = halt;
+    this->rtc_carry_ = (registers[4] & 0x80) != 0;
+
+    // Out-of-range values are folded into the count rather than kept as written.
+    const uint64_t days = registers[3] | (static_cast<uint64_t>(registers[4] & 0x01) << 8);
+    const uint64_t seconds = (registers[0] & 0x3F) + (registers[1] & 0x3F) * 60ULL + (registers[2] & 0x1F) * 3600ULL;
+    this->rtc_seconds_ = (days * k_seconds_per_day + seconds) % (k_rtc_days * k_seconds_per_day);
+}
+
+void Mbc::load_battery(std::istream &in) {
+    in.read(reinterpret_cast<char *>(this->ram_.data()), static_cast<std::streamsize>(this->ram_.size()));
+    if (!this->rtc_) return;
+
+    std::array<uint8_t, k_rtc_footer_size> footer{};
+    in.read(reinterpret_cast<char *>(footer.data()), static_cast<std::streamsize>(footer.size()));
+    if (in.gcount() < 44) return; // No clock saved yet; some emulators store a 32-bit time
+
+    auto field = [&footer](size_t index) { return footer[index * 4]; };
+    std::array<uint8_t, 5> live{};
+    for (size_t i = 0; i < live.size(); ++i) {
+        live[i] = field(i);
+        this->rtc_latched_[i] = field(i + 5);
+    }
+    uint64_t saved_at = 0;
+    const size_t time_bytes = in.gcount() == static_cast<std::streamsize>(k_rtc_footer_size) ? 8 : 4;
+    for (size_t i = 0; i < time_bytes; ++i) saved_at |= static_cast<uint64_t>(footer[40 + i]) << (8 * i);
+
+    this->rtc_write(0x0C, live[4]); // Halt first, so setting the rest does not tick
+    for (uint8_t select = k_rtc_first_register; select < k_rtc_last_register; ++select) {
+        this->rtc_write(select, live[select - k_rtc_first_register]);
+    }
+    // The clock kept running while the emulator was not.
+    const uint64_t now = unix_time();
+    if (!this->rtc_halted_ && now > saved_at) this->rtc_add_seconds(now - saved_at);
+}
+
+void Mbc::save_battery(std::ostream &out) {
+    out.write(reinterpret_cast<const char *>(this->ram_.data()), static_cast<std::streamsize>(this->ram_.size()));
+    if (!this->rtc_) return;
+
+    this->rtc_sync();
+    const std::array<uint8_t, 5> live = this->rtc_registers();
+    std::array<uint8_t, k_rtc_footer_size> footer{};
+    for (size_t i = 0; i < live.size(); ++i) {
+        footer[i * 4] = live[i];
+        footer[(i + 5) * 4] = this->rtc_latched_[i];
+    }
+    const uint64_t saved_at = unix_time();
+    for (size_t i = 0; i < 8; ++i) footer[40 + i] = static_cast<uint8_t>(saved_at >> (8 * i));
+    out.write(reinterpret_cast<const char *>(footer.data()), static_cast<std::streamsize>(footer.size()));
+}
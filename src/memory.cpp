@@ -1,5 +1,10 @@
 #include "memory.hpp"
-#include "joypad.hpp"
+#include "block_cache.hpp"
+#include "mbc.hpp"
+#include "rom_image.hpp"
+
+#include <algorithm>
+#include <cstring>
 
 namespace {
 constexpr uint16_t k_rom_end = 0x7FFF;
@@ -13,33 +18,116 @@ constexpr uint16_t k_echo_start = 0xE000;
 constexpr uint16_t k_echo_end = 0xFDFF;
 constexpr uint16_t k_oam_start = 0xFE00;
 constexpr uint16_t k_oam_end = 0xFE9F;
-constexpr uint16_t k_not_usable_start = 0xFEA0;
-constexpr uint16_t k_not_usable_end = 0xFEFF;
 constexpr uint16_t k_io_start = 0xFF00;
 constexpr uint16_t k_io_end = 0xFF7F;
 constexpr uint16_t k_hram_start = 0xFF80;
 constexpr uint16_t k_hram_end = 0xFFFE;
 
-constexpr uint16_t k_joyp = 0xFF00;
-constexpr uint16_t k_div = 0xFF04;
 constexpr uint16_t k_if = 0xFF0F;
-constexpr uint16_t k_dma = 0xFF46;
 constexpr uint16_t k_ie = 0xFFFF;
 
+constexpr size_t k_host_page_size = 0x100;
+constexpr size_t k_rom_bank_size = 0x4000;
+constexpr size_t k_bank_pages = 0x2000 / k_host_page_size; // VRAM, cartridge RAM and WRAM are 8 KiB each
+
+constexpr size_t page_index(uint16_t address) { return address >> 8; }
+
 constexpr bool in_range(uint16_t address, uint16_t start, uint16_t end) { return address >= start && address <= end; }
 
 constexpr size_t range_offset(uint16_t address, uint16_t start) { return static_cast<size_t>(address - start); }
 } // namespace
 
-void Memory::load_rom(const std::vector<uint8_t> &rom) { this->rom_ = rom; }
+Memory::Memory() {
+    for (size_t page = 0; page < k_bank_pages; ++page) {
+        uint8_t *wram_page = &this->wram_[page * k_host_page_size];
+        const size_t wram_index = page_index(k_wram_start) + page;
+        this->read_pages_[wram_index] = wram_page;
+        this->unlocked_read_pages_[wram_index] = wram_page;
+        this->write_pages_[wram_index] = wram_page;
+
+        // Echo RAM stops short of the OAM page. Echo writes stay on the handlers, which invalidate cached code by the
+        // WRAM address.
+        const size_t echo_index = page_index(k_echo_start) + page;
+        if (echo_index >= page_index(k_oam_start)) continue;
+        this->read_pages_[echo_index] = wram_page;
+        this->unlocked_read_pages_[echo_index] = wram_page;
+    }
+
+    this->map_rom_pages();
+    this->map_eram(nullptr);
+    this->map_vram();
+}
+
+void Memory::load_rom(const RomImage &rom) {
+    this->rom_ = rom.data();
+    this->rom_length_ = rom.size();
+    this->rom_banks_ = {0, 1};
+    this->rom_offsets_ = {0, k_rom_bank_size};
+    this->map_rom_pages();
+}
+
+void Memory::map_rom(uint32_t low_bank, uint32_t high_bank) {
+    const size_t bank_count = std::max<size_t>((this->rom_length_ + k_rom_bank_size - 1) / k_rom_bank_size, 1);
+    const std::array<uint16_t, 2> banks = {static_cast<uint16_t>(low_bank % bank_count), static_cast<uint16_t>(high_bank % bank_count)};
+    if (banks == this->rom_banks_) return;
+
+    this->rom_banks_ = banks;
+    this->rom_offsets_ = {banks[0] * k_rom_bank_size, banks[1] * k_rom_bank_size};
+    this->map_rom_pages();
+    // Cached blocks stay valid under their bank, but one being executed may just have been switched out.
+    if (this->block_cache_ != nullptr) this->block_cache_->notify_bank_switch();
+}
+
+void Memory::map_rom_pages() {
+    // A ROM that ends mid-page leaves that page to the handlers, which read 0xFF past the end.
+    for (size_t page = 0; page <= page_index(k_rom_end); ++page) {
+        const size_t offset = this->rom_offset(static_cast<uint16_t>(page * k_host_page_size));
+        const uint8_t *rom_page = offset + k_host_page_size <= this->rom_length_ ? this->rom_ + offset : nullptr;
+        this->read_pages_[page] = rom_page;
+        this->unlocked_read_pages_[page] = rom_page;
+    }
+}
+
+size_t Memory::rom_size() const {
+    const size_t contiguous = this->rom_offsets_[1] == this->rom_offsets_[0] + k_rom_bank_size ? 2 * k_rom_bank_size : k_rom_bank_size;
+    return std::min(contiguous, this->rom_length_ - std::min(this->rom_offsets_[0], this->rom_length_));
+}
+
+void Memory::map_eram(uint8_t *bank) {
+    for (size_t page = 0; page < k_bank_pages; ++page) {
+        uint8_t *eram_page = bank != nullptr ? bank + page * k_host_page_size : nullptr;
+        const size_t index = page_index(k_eram_start) + page;
+        this->read_pages_[index] = eram_page;
+        this->unlocked_read_pages_[index] = eram_page;
+        this->write_pages_[index] = eram_page;
+    }
+}
 
-uint8_t Memory::read_byte(uint16_t address) const { return this->read_byte_impl(address, true); }
+void Memory::map_vram() {
+    for (size_t page = 0; page < k_bank_pages; ++page) {
+        uint8_t *vram_page = &this->vram_[page * k_host_page_size];
+        const size_t index = page_index(k_vram_start) + page;
+        this->unlocked_read_pages_[index] = vram_page;
+        this->read_pages_[index] = this->vram_blocked_ ? nullptr : vram_page;
+        this->write_pages_[index] = this->vram_blocked_ ? nullptr : vram_page;
+    }
+}
 
-uint8_t Memory::read_byte_unrestricted(uint16_t address) const { return this->read_byte_impl(address, false); }
+void Memory::invalidate_code(uint16_t address) { this->block_cache_->notify_write(address); }
 
 uint8_t Memory::read_byte_impl(uint16_t address, bool respect_locks) const {
+    // The IO/HRAM page is the most common one to get here.
+    if (address >= k_io_start) {
+        if (in_range(address, k_hram_start, k_hram_end)) return this->hram_[range_offset(address, k_hram_start)];
+        if (address == k_ie) return this->ie_;
+        const IoHandler &handler = this->io_handlers_[range_offset(address, k_io_start)];
+        if (handler.read != nullptr) return handler.read(handler.owner, address);
+        return this->io_[range_offset(address, k_io_start)];
+    }
+
     if (address <= k_rom_end) {
-        if (address < this->rom_.size()) return this->rom_[address];
+        const size_t offset = this->rom_offset(address);
+        if (offset < this->rom_length_) return this->rom_[offset];
         return 0xFF;
     }
 
@@ -49,9 +137,8 @@ uint8_t Memory::read_byte_impl(uint16_t address, bool respect_locks) const {
     }
 
     if (in_range(address, k_eram_start, k_eram_end)) {
-        if (this->eram_.empty()) return 0xFF;
-        const size_t eram_index = range_offset(address, k_eram_start) % this->eram_.size();
-        return this->eram_[eram_index];
+        if (this->mbc_ == nullptr) return 0xFF;
+        return this->mbc_->read_ram(address);
     }
 
     if (in_range(address, k_wram_start, k_wram_end)) {
@@ -68,22 +155,36 @@ uint8_t Memory::read_byte_impl(uint16_t address, bool respect_locks) const {
         return this->oam_[range_offset(address, k_oam_start)];
     }
 
-    if (in_range(address, k_not_usable_start, k_not_usable_end)) return 0xFF;
+    return 0xFF; // 0xFEA0-0xFEFF is not usable
+}
 
-    if (in_range(address, k_io_start, k_io_end)) {
-        if (address == k_joyp && this->joypad_ != nullptr) return this->joypad_->get_joyp();
-        return this->io_[range_offset(address, k_io_start)];
+void Memory::write_byte_slow(uint16_t address, uint8_t value) {
+    // The IO/HRAM page first, as for reads.
+    if (in_range(address, k_hram_start, k_hram_end)) {
+        this->hram_[range_offset(address, k_hram_start)] = value;
+        if (this->block_cache_ != nullptr) this->block_cache_->notify_write(address);
+        return;
     }
 
-    if (in_range(address, k_hram_start, k_hram_end)) {
-        return this->hram_[range_offset(address, k_hram_start)];
+    if (address == k_ie) {
+        this->ie_ = value;
+        return;
     }
 
-    return this->ie_;
-}
+    if (in_range(address, k_io_start, k_io_end)) {
+        const IoHandler &handler = this->io_handlers_[range_offset(address, k_io_start)];
+        if (handler.write != nullptr) {
+            handler.write(handler.owner, address, value);
+        } else {
+            this->io_[range_offset(address, k_io_start)] = value;
+        }
+        return;
+    }
 
-void Memory::write_byte(uint16_t address, uint8_t value) {
-    if (address <= k_rom_end) return;
+    if (address <= k_rom_end) {
+        if (this->mbc_ != nullptr) this->mbc_->write_register(address, value);
+        return;
+    }
 
     if (in_range(address, k_vram_start, k_vram_end)) {
         if (this->vram_blocked_) return;
@@ -92,21 +193,20 @@ void Memory::write_byte(uint16_t address, uint8_t value) {
     }
 
     if (in_range(address, k_eram_start, k_eram_end)) {
-        if (!this->eram_.empty()) {
-            const size_t eram_index = range_offset(address, k_eram_start) % this->eram_.size();
-            this->eram_[eram_index] = value;
-        }
+        if (this->mbc_ != nullptr) this->mbc_->write_ram(address, value);
         return;
     }
 
     if (in_range(address, k_wram_start, k_wram_end)) {
         this->wram_[range_offset(address, k_wram_start)] = value;
+        if (this->block_cache_ != nullptr) this->block_cache_->notify_write(address);
         return;
     }
 
     if (in_range(address, k_echo_start, k_echo_end)) {
         const uint16_t mirrored = static_cast<uint16_t>(address - 0x2000);
         this->wram_[range_offset(mirrored, k_wram_start)] = value;
+        if (this->block_cache_ != nullptr) this->block_cache_->notify_write(mirrored);
         return;
     }
 
@@ -116,36 +216,7 @@ void Memory::write_byte(uint16_t address, uint8_t value) {
         return;
     }
 
-    if (in_range(address, k_not_usable_start, k_not_usable_end)) return;
-
-    if (in_range(address, k_io_start, k_io_end)) {
-        if (address == k_joyp && this->joypad_ != nullptr) {
-            this->joypad_->set_joyp(value);
-            this->io_[range_offset(address, k_io_start)] = value;
-            return;
-        }
-
-        if (address == k_div) {
-            this->io_[range_offset(address, k_io_start)] = 0;
-            this->div_reset_pending_ = true;
-            return;
-        }
-
-        if (address == k_dma) {
-            this->dma_request_pending_ = true;
-            this->dma_source_high_ = value;
-        }
-
-        this->io_[range_offset(address, k_io_start)] = value;
-        return;
-    }
-
-    if (in_range(address, k_hram_start, k_hram_end)) {
-        this->hram_[range_offset(address, k_hram_start)] = value;
-        return;
-    }
-
-    this->ie_ = value;
+    // 0xFEA0-0xFEFF is not usable
 }
 
 uint16_t Memory::read_word(uint16_t address) const {
@@ -192,25 +263,61 @@ uint8_t Memory::get_if() const { return this->read_byte(k_if); }
 
 void Memory::set_if(uint8_t value) { this->write_byte(k_if, value); }
 
-void Memory::attach_joypad(Joypad *joypad) { this->joypad_ = joypad; }
+void Memory::save_state(State &state) const {
+    state.vram = this->vram_;
+    state.wram = this->wram_;
+    state.oam = this->oam_;
+    state.io = this->io_;
+    state.hram = this->hram_;
+    state.ie = this->ie_;
+    state.vram_blocked = this->vram_blocked_;
+    state.oam_blocked = this->oam_blocked_;
+}
 
-uint8_t Memory::read_io_reg(uint16_t address) const {
-    if (!in_range(address, k_io_start, k_io_end)) return 0xFF;
-    return this->io_[range_offset(address, k_io_start)];
+void Memory::load_state(const State &state) {
+    if (this->block_cache_ != nullptr) {
+        for (size_t offset = 0; offset < this->wram_.size(); offset += k_code_page_size) {
+            if (std::memcmp(&this->wram_[offset], &state.wram[offset], k_code_page_size) != 0) {
+                this->block_cache_->notify_write(static_cast<uint16_t>(k_wram_start + offset));
+            }
+        }
+        for (size_t offset = 0; offset < this->hram_.size(); offset += k_code_page_size) {
+            const size_t length = std::min(k_code_page_size, this->hram_.size() - offset);
+            if (std::memcmp(&this->hram_[offset], &state.hram[offset], length) != 0) {
+                this->block_cache_->notify_write(static_cast<uint16_t>(k_hram_start + offset));
+            }
+        }
+    }
+
+    this->vram_ = state.vram;
+    this->wram_ = state.wram;
+    this->oam_ = state.oam;
+    this->io_ = state.io;
+    this->hram_ = state.hram;
+    this->ie_ = state.ie;
+    this->vram_blocked_ = state.vram_blocked;
+    this->oam_blocked_ = state.oam_blocked;
+    this->map_vram();
 }
 
-void Memory::write_io_reg(uint16_t address, uint8_t value) {
+void Memory::set_io_handler(uint16_t address, const IoHandler &handler) {
     if (!in_range(address, k_io_start, k_io_end)) return;
-    this->io_[range_offset(address, k_io_start)] = value;
+    this->io_handlers_[range_offset(address, k_io_start)] = handler;
 }
 
-bool Memory::consume_div_reset() {
-    const bool was_pending = this->div_reset_pending_;
-    this->div_reset_pending_ = false;
-    return was_pending;
+void Memory::attach_mbc(Mbc *mbc) { this->mbc_ = mbc; }
+
+void Memory::attach_block_cache(BlockCache *block_cache) {
+    this->block_cache_ = block_cache;
+    this->code_pages_ = block_cache != nullptr ? block_cache->code_page_map() : nullptr;
 }
 
-void Memory::set_vram_blocked(bool blocked) { this->vram_blocked_ = blocked; }
+// The PPU sets the locks on every mode change; only an actual change touches the page table.
+void Memory::set_vram_blocked(bool blocked) {
+    if (blocked == this->vram_blocked_) return;
+    this->vram_blocked_ = blocked;
+    this->map_vram();
+}
 
 void Memory::set_oam_blocked(bool blocked) { this->oam_blocked_ = blocked; }
 
@@ -229,9 +336,12 @@ void Memory::write_oam_raw(uint16_t address, uint8_t value) {
     this->oam_[range_offset(address, k_oam_start)] = value;
 }
 
-bool Memory::consume_dma_request(uint8_t &source_high) {
-    if (!this->dma_request_pending_) return false;
-    this->dma_request_pending_ = false;
-    source_high = this->dma_source_high_;
-    return true;
+uint8_t Memory::read_io_raw(uint16_t address) const {
+    if (!in_range(address, k_io_start, k_io_end)) return 0xFF;
+    return this->io_[range_offset(address, k_io_start)];
+}
+
+void Memory::write_io_raw(uint16_t address, uint8_t value) {
+    if (!in_range(address, k_io_start, k_io_end)) return;
+    this->io_[range_offset(address, k_io_start)] = value;
 }
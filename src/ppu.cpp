@@ -3,12 +3,82 @@
 #include <algorithm>
 #include <array>
 
-PPU::PPU(Memory &memory, Screen &screen) : memory_(memory), screen_(screen) {}
+PPU::PPU(Memory &memory, Screen &screen, Scheduler &scheduler) : memory_(memory), screen_(screen), scheduler_(scheduler) {
+    const Memory::IoHandler handler = {
+        .owner = this,
+        .write = [](void *ppu, uint16_t address, uint8_t value) { static_cast<PPU *>(ppu)->write_register(address, value); }};
+    constexpr std::array<uint16_t, 4> k_registers = {0xFF40, 0xFF41, 0xFF44, 0xFF46};
+    for (const uint16_t address : k_registers) this->memory_.set_io_handler(address, handler);
+}
+
+void PPU::write_register(uint16_t address, uint8_t value) {
+    this->catch_up();
+    switch (address) {
+    case 0xFF41: // Mode and LYC match bits are read-only
+        this->set_stat(static_cast<uint8_t>((value & 0x78) | (this->get_stat() & 0x07)));
+        break;
+    case 0xFF44: // LY is read-only
+        break;
+    case 0xFF46:
+        this->memory_.write_io_raw(address, value);
+        this->begin_dma(value);
+        break;
+    default:
+        this->memory_.write_io_raw(address, value);
+        break;
+    }
+    this->request_catch_up();
+}
+
+void PPU::catch_up() {
+    this->catch_up_requested_ = false;
+    const uint64_t now = this->scheduler_.now();
+    while (this->synced_cycle_ < now) {
+        const uint32_t dots = static_cast<uint32_t>(std::min<uint64_t>(now - this->synced_cycle_, UINT32_MAX));
+        this->tick(dots);
+        this->synced_cycle_ += dots;
+    }
+}
+
+void PPU::save_state(State &state) const {
+    state = {.synced_cycle = this->synced_cycle_,
+             .catch_up_requested = this->catch_up_requested_,
+             .dot_in_scanline = this->dot_in_scanline,
+             .current_ly = this->current_ly,
+             .mode = this->mode_,
+             .frame_ready = this->frame_ready,
+             .lcd_enabled = this->lcd_enabled,
+             .stat_irq_line = this->stat_irq_line,
+             .scanline_rendered = this->scanline_rendered,
+             .dma_active = this->dma_active,
+             .dma_source_base = this->dma_source_base,
+             .dma_index = this->dma_index,
+             .dma_dot_counter = this->dma_dot_counter,
+             .skip_frame = this->skip_frame_};
+}
+
+void PPU::load_state(const State &state) {
+    this->synced_cycle_ = state.synced_cycle;
+    this->catch_up_requested_ = state.catch_up_requested;
+    this->dot_in_scanline = state.dot_in_scanline;
+    this->current_ly = state.current_ly;
+    this->mode_ = state.mode;
+    this->frame_ready = state.frame_ready;
+    this->lcd_enabled = state.lcd_enabled;
+    this->stat_irq_line = state.stat_irq_line;
+    this->scanline_rendered = state.scanline_rendered;
+    this->dma_active = state.dma_active;
+    this->dma_source_base = state.dma_source_base;
+    this->dma_index = state.dma_index;
+    this->dma_dot_counter = state.dma_dot_counter;
+    this->skip_frame_ = state.skip_frame;
+}
 
 void PPU::tick(uint32_t dots) {
     const bool lcd_now_enabled = (this->get_lcdc() & 0x80) != 0;
     if (!lcd_now_enabled) {
         this->reset_lcd_off_state();
+        this->schedule_events();
         return;
     }
 
@@ -18,29 +88,34 @@ void PPU::tick(uint32_t dots) {
         this->current_ly = 0;
         this->mode_ = 2;
         this->frame_ready = false;
+        this->skip_frame_ = this->skip_requested_;
         this->set_ly(0);
         this->set_ppu_mode(this->mode_);
     }
     this->lcd_enabled = true;
 
     for (uint32_t i = 0; i < dots; ++i) {
-        uint8_t dma_source_high = 0;
-        if (this->memory_.consume_dma_request(dma_source_high)) {
-            this->begin_dma(dma_source_high);
-        }
-
         this->tick_dma_one_dot();
         this->update_mode_for_current_dot();
         this->apply_memory_locks();
 
         if (!this->scanline_rendered && this->current_ly < this->visible_scanlines && this->mode_ == 0) {
-            this->render_scanline();
+            if (!this->skip_frame_) this->render_scanline();
             this->scanline_rendered = true;
         }
 
         this->dot_in_scanline += 1;
 
-        if (this->dot_in_scanline < this->dots_per_scanline) continue;
+        if (this->dot_in_scanline < this->dots_per_scanline) {
+            // Between mode changes, and with no DMA running, the per-dot work above does nothing: skip ahead to the
+            // next dot that matters. DMA is only started by a CPU write, so none can begin during this call.
+            if (!this->dma_active) {
+                const uint32_t span = std::min(dots - i - 1, static_cast<uint32_t>(this->next_busy_dot() - this->dot_in_scanline));
+                this->dot_in_scanline += static_cast<int>(span);
+                i += span;
+            }
+            continue;
+        }
 
         this->dot_in_scanline = 0;
         this->current_ly += 1;
@@ -57,6 +132,7 @@ void PPU::tick(uint32_t dots) {
             this->mode_ = 2;
             this->set_ppu_mode(this->mode_);
             this->frame_ready = false;
+            this->skip_frame_ = this->skip_requested_;
         } else if (this->current_ly < this->visible_scanlines) {
             this->mode_ = 2;
             this->set_ppu_mode(this->mode_);
@@ -66,6 +142,37 @@ void PPU::tick(uint32_t dots) {
         this->update_lyc_flag_and_stat_interrupt();
         this->apply_memory_locks();
     }
+
+    this->schedule_events();
+}
+
+void PPU::schedule_events() {
+    const uint32_t dots = this->dots_until_next_event();
+    this->scheduler_.schedule_in(SchedulerEvent::PpuMode, dots);
+    if (dots == UINT32_MAX) {
+        this->scheduler_.cancel(SchedulerEvent::VBlank);
+        return;
+    }
+
+    // Line 144 starts when the change on the last dot of line 143 is processed.
+    const int lines = (this->visible_scanlines - 1 - this->current_ly + this->total_scanlines) % this->total_scanlines;
+    const int vblank_dots = lines * this->dots_per_scanline + this->dots_per_scanline - 1 - this->dot_in_scanline;
+    this->scheduler_.schedule_in(SchedulerEvent::VBlank, static_cast<uint32_t>(vblank_dots));
+}
+
+int PPU::next_busy_dot() const {
+    if (this->current_ly < this->visible_scanlines) {
+        if (this->dot_in_scanline <= this->oam_dots) return this->oam_dots;
+        if (this->dot_in_scanline <= this->oam_dots + this->transfer_dots) return this->oam_dots + this->transfer_dots;
+    }
+    return this->dots_per_scanline - 1; // The line change is processed on this dot
+}
+
+uint32_t PPU::dots_until_next_event() {
+    if (this->dma_active) return 0;
+    if (!this->lcd_enabled || (this->get_lcdc() & 0x80) == 0) return UINT32_MAX;
+
+    return static_cast<uint32_t>(std::max(this->next_busy_dot() - this->dot_in_scanline, 0));
 }
 
 bool PPU::consume_frame_ready() {
@@ -322,17 +429,17 @@ void PPU::tick_dma_one_dot() {
     }
 }
 
-uint8_t PPU::get_lcdc() { return this->memory_.read_byte(0xFF40); }
-void PPU::set_lcdc(uint8_t value) { this->memory_.write_byte(0xFF40, value); }
+uint8_t PPU::get_lcdc() { return this->memory_.read_io_raw(0xFF40); }
+void PPU::set_lcdc(uint8_t value) { this->memory_.write_io_raw(0xFF40, value); }
 
-uint8_t PPU::get_ly() { return this->memory_.read_byte(0xFF44); }
-void PPU::set_ly(uint8_t value) { this->memory_.write_byte(0xFF44, value); }
+uint8_t PPU::get_ly() { return this->memory_.read_io_raw(0xFF44); }
+void PPU::set_ly(uint8_t value) { this->memory_.write_io_raw(0xFF44, value); }
 
-uint8_t PPU::get_lyc() { return this->memory_.read_byte(0xFF45); }
-void PPU::set_lyc(uint8_t value) { this->memory_.write_byte(0xFF45, value); }
+uint8_t PPU::get_lyc() { return this->memory_.read_io_raw(0xFF45); }
+void PPU::set_lyc(uint8_t value) { this->memory_.write_io_raw(0xFF45, value); }
 
-uint8_t PPU::get_stat() { return this->memory_.read_byte(0xFF41); }
-void PPU::set_stat(uint8_t value) { this->memory_.write_byte(0xFF41, value); }
+uint8_t PPU::get_stat() { return this->memory_.read_io_raw(0xFF41); }
+void PPU::set_stat(uint8_t value) { this->memory_.write_io_raw(0xFF41, value); }
 
 uint8_t PPU::get_ppu_mode() {
     uint8_t stat = this->get_stat();
@@ -344,23 +451,23 @@ void PPU::set_ppu_mode(uint8_t mode) {
     this->set_stat(stat);
 }
 
-uint8_t PPU::get_scy() { return this->memory_.read_byte(0xFF42); }
-void PPU::set_scy(uint8_t value) { this->memory_.write_byte(0xFF42, value); }
+uint8_t PPU::get_scy() { return this->memory_.read_io_raw(0xFF42); }
+void PPU::set_scy(uint8_t value) { this->memory_.write_io_raw(0xFF42, value); }
 
-uint8_t PPU::get_scx() { return this->memory_.read_byte(0xFF43); }
-void PPU::set_scx(uint8_t value) { this->memory_.write_byte(0xFF43, value); }
+uint8_t PPU::get_scx() { return this->memory_.read_io_raw(0xFF43); }
+void PPU::set_scx(uint8_t value) { this->memory_.write_io_raw(0xFF43, value); }
 
-uint8_t PPU::get_wy() { return this->memory_.read_byte(0xFF4A); }
-void PPU::set_wy(uint8_t value) { this->memory_.write_byte(0xFF4A, value); }
+uint8_t PPU::get_wy() { return this->memory_.read_io_raw(0xFF4A); }
+void PPU::set_wy(uint8_t value) { this->memory_.write_io_raw(0xFF4A, value); }
 
-uint8_t PPU::get_wx() { return this->memory_.read_byte(0xFF4B); }
-void PPU::set_wx(uint8_t value) { this->memory_.write_byte(0xFF4B, value); }
+uint8_t PPU::get_wx() { return this->memory_.read_io_raw(0xFF4B); }
+void PPU::set_wx(uint8_t value) { this->memory_.write_io_raw(0xFF4B, value); }
 
-uint8_t PPU::get_bgp() { return this->memory_.read_byte(0xFF47); }
-void PPU::set_bgp(uint8_t value) { this->memory_.write_byte(0xFF47, value); }
+uint8_t PPU::get_bgp() { return this->memory_.read_io_raw(0xFF47); }
+void PPU::set_bgp(uint8_t value) { this->memory_.write_io_raw(0xFF47, value); }
 
-uint8_t PPU::get_obp0() { return this->memory_.read_byte(0xFF48); }
-void PPU::set_obp0(uint8_t value) { this->memory_.write_byte(0xFF48, value); }
+uint8_t PPU::get_obp0() { return this->memory_.read_io_raw(0xFF48); }
+void PPU::set_obp0(uint8_t value) { this->memory_.write_io_raw(0xFF48, value); }
 
-uint8_t PPU::get_obp1() { return this->memory_.read_byte(0xFF49); }
-void PPU::set_obp1(uint8_t value) { this->memory_.write_byte(0xFF49, value); }
+uint8_t PPU::get_obp1() { return this->memory_.read_io_raw(0xFF49); }
+void PPU::set_obp1(uint8_t value) { this->memory_.write_io_raw(0xFF49, value); }
@@ -4,49 +4,56 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
-
-Registers::Registers() : A(0), B(0), C(0), D(0), E(0), F(0), H(0), L(0), SP(0), PC(0), IME(false) {}
-
-void Registers::set_af(uint16_t value) {
-    this->A = static_cast<uint8_t>((value & 0xFF00) >> 8);
-    this->F = static_cast<uint8_t>(value & 0x00F0);
-}
-uint16_t Registers::get_af() { return static_cast<uint16_t>((static_cast<uint16_t>(this->A) << 8U) | static_cast<uint16_t>(this->F)); }
-
-void Registers::set_bc(uint16_t value) {
-    this->B = static_cast<uint8_t>((value & 0xFF00) >> 8);
-    this->C = static_cast<uint8_t>(value & 0x00FF);
-}
-uint16_t Registers::get_bc() { return static_cast<uint16_t>((static_cast<uint16_t>(this->B) << 8U) | static_cast<uint16_t>(this->C)); }
-
-void Registers::set_de(uint16_t value) {
-    this->D = static_cast<uint8_t>((value & 0xFF00) >> 8);
-    this->E = static_cast<uint8_t>(value & 0x00FF);
-}
-uint16_t Registers::get_de() { return static_cast<uint16_t>((static_cast<uint16_t>(this->D) << 8U) | static_cast<uint16_t>(this->E)); }
-
-void Registers::set_hl(uint16_t value) {
-    this->H = static_cast<uint8_t>((value & 0xFF00) >> 8);
-    this->L = static_cast<uint8_t>(value & 0x00FF);
-}
-uint16_t Registers::get_hl() { return static_cast<uint16_t>((static_cast<uint16_t>(this->H) << 8U) | static_cast<uint16_t>(this->L)); }
-
-void Registers::set_flag_z(bool value) {
-    this->F = static_cast<uint8_t>((this->F & static_cast<uint8_t>(~FLAG_Z_MASK)) | (value ? FLAG_Z_MASK : 0x00));
-}
-bool Registers::get_flag_z() { return (this->F & FLAG_Z_MASK) != 0; }
-
-void Registers::set_flag_n(bool value) {
-    this->F = static_cast<uint8_t>((this->F & static_cast<uint8_t>(~FLAG_N_MASK)) | (value ? FLAG_N_MASK : 0x00));
-}
-bool Registers::get_flag_n() { return (this->F & FLAG_N_MASK) != 0; }
-
-void Registers::set_flag_h(bool value) {
-    this->F = static_cast<uint8_t>((this->F & static_cast<uint8_t>(~FLAG_H_MASK)) | (value ? FLAG_H_MASK : 0x00));
-}
-bool Registers::get_flag_h() { return (this->F & FLAG_H_MASK) != 0; }
-
-void Registers::set_flag_c(bool value) {
-    this->F = static_cast<uint8_t>((this->F & static_cast<uint8_t>(~FLAG_C_MASK)) | (value ? FLAG_C_MASK : 0x00));
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+Registers::Registers() : AF(0), BC(0), DE(0), HL(0), SP(0), PC(0), IME(false) {}
+
+uint8_t Registers::evaluate_flags() const {
+    const int lhs = this->flag_lhs_;
+    const int rhs = this->flag_rhs_;
+    const int carry = this->flag_carry_;
+    const uint8_t old_c = this->F & FLAG_C_MASK;
+
+    switch (this->flag_op_) {
+    case FlagOp::Add: {
+        const int sum = lhs + rhs + carry;
+        const uint8_t z = (sum & 0xFF) == 0 ? FLAG_Z_MASK : 0x00;
+        const uint8_t h = (lhs & 0x0F) + (rhs & 0x0F) + carry > 0x0F ? FLAG_H_MASK : 0x00;
+        const uint8_t c = sum > 0xFF ? FLAG_C_MASK : 0x00;
+        return static_cast<uint8_t>(z | h | c);
+    }
+    case FlagOp::Sub: {
+        const int diff = lhs - rhs - carry;
+        const uint8_t z = (diff & 0xFF) == 0 ? FLAG_Z_MASK : 0x00;
+        const uint8_t h = (lhs & 0x0F) - (rhs & 0x0F) - carry < 0 ? FLAG_H_MASK : 0x00;
+        const uint8_t c = diff < 0 ? FLAG_C_MASK : 0x00;
+        return static_cast<uint8_t>(z | FLAG_N_MASK | h | c);
+    }
+    case FlagOp::And:
+        return static_cast<uint8_t>((lhs == 0 ? FLAG_Z_MASK : 0x00) | FLAG_H_MASK);
+    case FlagOp::Or:
+        return static_cast<uint8_t>(lhs == 0 ? FLAG_Z_MASK : 0x00);
+    case FlagOp::Inc:
+        return static_cast<uint8_t>((lhs == 0 ? FLAG_Z_MASK : 0x00) | ((lhs & 0x0F) == 0x00 ? FLAG_H_MASK : 0x00) | old_c);
+    case FlagOp::Dec:
+        return static_cast<uint8_t>((lhs == 0 ? FLAG_Z_MASK : 0x00) | FLAG_N_MASK | ((lhs & 0x0F) == 0x0F ? FLAG_H_MASK : 0x00) | old_c);
+    case FlagOp::None:
+        break;
+    }
+    return this->F;
+}
+
+// Debug builds compute the eager flags into F before deferring, so both paths must agree here.
+void Registers::verify_deferred_flags() const {
+    const uint8_t lazy = this->evaluate_flags();
+    if (lazy != this->F) {
+        std::stringstream ss;
+        ss << "Lazy flags mismatch: op " << static_cast<int>(this->flag_op_) << " lhs 0x" << std::hex << std::setw(2) << std::setfill('0')
+           << static_cast<int>(this->flag_lhs_) << " rhs 0x" << std::setw(2) << static_cast<int>(this->flag_rhs_) << " carry "
+           << static_cast<int>(this->flag_carry_) << " lazy F 0x" << std::setw(2) << static_cast<int>(lazy) << " eager F 0x" << std::setw(2)
+           << static_cast<int>(this->F);
+        throw std::runtime_error(ss.str());
+    }
 }
-bool Registers::get_flag_c() { return (this->F & FLAG_C_MASK) != 0; }
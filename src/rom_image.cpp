@@ -0,0 +1,48 @@
+#include "rom_image.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#define GBEMU_ROM_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+RomImage::RomImage(const std::string &filename) {
+#if defined(GBEMU_ROM_MMAP)
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Unable to open file: " + filename);
+    struct stat info {};
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        const size_t size = static_cast<size_t>(info.st_size);
+        void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            this->data_ = static_cast<const uint8_t *>(data);
+            this->size_ = size;
+            this->mapped_ = true;
+        }
+    }
+    close(fd); // The mapping keeps its own reference to the file
+    if (this->mapped_) return;
+#endif
+
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) throw std::runtime_error("Unable to open file: " + filename);
+
+    // One read of the whole file instead of going through it byte by byte.
+    const std::streamsize size = file.tellg();
+    this->heap_.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char *>(this->heap_.data()), size)) throw std::runtime_error("Unable to read file: " + filename);
+    this->data_ = this->heap_.data();
+    this->size_ = this->heap_.size();
+}
+
+RomImage::~RomImage() {
+#if defined(GBEMU_ROM_MMAP)
+    if (this->mapped_) munmap(const_cast<uint8_t *>(this->data_), this->size_);
+#endif
+}
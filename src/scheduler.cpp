@@ -0,0 +1,38 @@
+#include "scheduler.hpp"
+
+#include <algorithm>
+#include <functional>
+
+Scheduler::Scheduler() { this->pending_.fill(k_never); }
+
+void Scheduler::schedule(SchedulerEvent event, uint64_t cycle) {
+    uint64_t &pending = this->pending_[static_cast<size_t>(event)];
+    if (pending == cycle) return;
+
+    pending = cycle;
+    if (cycle == k_never) return;
+    this->heap_.push_back({cycle, event});
+    std::push_heap(this->heap_.begin(), this->heap_.end(), std::greater<Entry>());
+}
+
+void Scheduler::schedule_in(SchedulerEvent event, uint32_t cycles) {
+    this->schedule(event, cycles == UINT32_MAX ? k_never : this->now_ + cycles);
+}
+
+void Scheduler::cancel(SchedulerEvent event) { this->schedule(event, k_never); }
+
+uint64_t Scheduler::next_event_cycle() {
+    while (!this->heap_.empty()) {
+        const Entry &top = this->heap_.front();
+        if (this->pending_[static_cast<size_t>(top.event)] == top.cycle) return top.cycle;
+
+        std::pop_heap(this->heap_.begin(), this->heap_.end(), std::greater<Entry>());
+        this->heap_.pop_back();
+    }
+    return k_never;
+}
+
+uint32_t Scheduler::cycles_until(uint64_t cycle) const {
+    if (cycle <= this->now_) return 0;
+    return static_cast<uint32_t>(std::min<uint64_t>(cycle - this->now_, UINT32_MAX));
+}
@@ -3,10 +3,10 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
-#include <cstring>
 #include <vector>
 
-Screen::Screen() { memset(this->screen_, 0, sizeof(this->screen_)); }
+Screen::Screen() = default;
+
 void Screen::set(size_t x, size_t y, uint8_t color) {
     assert(color < 4U);
     // clang-format off
@@ -15,9 +15,9 @@ void Screen::set(size_t x, size_t y, uint8_t color) {
         y < config::k_screen_height
     );
     // clang-format on
-    this->screen_[x][y] = color;
+    this->frames_[this->back_][x][y] = color;
 }
-void Screen::clear() { memset(this->screen_, 0, sizeof(this->screen_)); }
+void Screen::clear() { this->frames_[this->back_] = Frame{}; }
 
 void Screen::draw_logo(const std::vector<uint8_t> &logo) {
     if (logo.size() < 48) return;
@@ -53,14 +53,23 @@ void Screen::draw_logo(const std::vector<uint8_t> &logo) {
 
 void Screen::set_renderer(SDL_Renderer *renderer) { this->renderer_ = renderer; }
 void Screen::set_texture(SDL_Texture *texture) { this->texture_ = texture; }
-void Screen::present() {
+void Screen::publish() {
+    const uint8_t previous = this->middle_.exchange(static_cast<uint8_t>(this->back_ | k_fresh), std::memory_order_acq_rel);
+    this->back_ = static_cast<uint8_t>(previous & ~k_fresh);
+}
+
+bool Screen::present() {
     assert(this->renderer_ != nullptr);
     assert(this->texture_ != nullptr);
 
+    if ((this->middle_.load(std::memory_order_relaxed) & k_fresh) == 0) return false;
+    this->front_ = static_cast<uint8_t>(this->middle_.exchange(this->front_, std::memory_order_acq_rel) & ~k_fresh);
+    const Frame &frame = this->frames_[this->front_];
+
     uint32_t pixels[config::k_screen_width * config::k_screen_height];
     for (size_t y = 0; y < config::k_screen_height; ++y) {
         for (size_t x = 0; x < config::k_screen_width; ++x) {
-            pixels[y * config::k_screen_width + x] = this->palette_[this->screen_[x][y]];
+            pixels[y * config::k_screen_width + x] = this->palette_[frame[x][y]];
         }
     }
 
@@ -69,4 +78,5 @@ void Screen::present() {
     SDL_RenderClear(this->renderer_);
     SDL_RenderCopy(this->renderer_, this->texture_, nullptr, nullptr);
     SDL_RenderPresent(this->renderer_);
+    return true;
 }
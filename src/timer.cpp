@@ -1,50 +1,128 @@
 #include "timer.hpp"
 
-Timer::Timer(Registers &registers, Memory &memory, bool &stopped) : registers_(registers), memory_(memory), stopped_(stopped) {}
+Timer::Timer(Registers &registers, Memory &memory, Scheduler &scheduler, bool &stopped)
+    : registers_(registers), memory_(memory), scheduler_(scheduler), stopped_(stopped) {
+    const Memory::IoHandler handler = {
+        .owner = this,
+        .read = [](void *timer, uint16_t address) { return static_cast<Timer *>(timer)->read_register(address); },
+        .write = [](void *timer, uint16_t address, uint8_t value) { static_cast<Timer *>(timer)->write_register(address, value); }};
+    for (uint16_t address = 0xFF04; address <= 0xFF07; ++address) this->memory_.set_io_handler(address, handler);
+}
+
+void Timer::save_state(State &state) const {
+    state = {.div = this->div_,
+             .tima = this->tima_,
+             .tma = this->tma_,
+             .tac = this->tac_,
+             .synced_cycle = this->synced_cycle_,
+             .catch_up_requested = this->catch_up_requested_,
+             .div_reset_pending = this->div_reset_pending_,
+             .div_m_cycles_counter = this->div_m_cycles_counter_,
+             .tima_m_cycles_counter = this->tima_m_cycles_counter_};
+}
+
+void Timer::load_state(const State &state) {
+    this->div_ = state.div;
+    this->tima_ = state.tima;
+    this->tma_ = state.tma;
+    this->tac_ = state.tac;
+    this->synced_cycle_ = state.synced_cycle;
+    this->catch_up_requested_ = state.catch_up_requested;
+    this->div_reset_pending_ = state.div_reset_pending;
+    this->div_m_cycles_counter_ = state.div_m_cycles_counter;
+    this->tima_m_cycles_counter_ = state.tima_m_cycles_counter;
+}
 
-void Timer::tick(uint32_t dots) {
-    const int m_cycles = dots / 4;
+void Timer::catch_up() {
+    this->catch_up_requested_ = false;
+    const uint64_t now = this->scheduler_.now();
+    if (this->synced_cycle_ != now) {
+        this->tick((now - this->synced_cycle_) / 4);
+        this->synced_cycle_ = now;
+    }
+    this->scheduler_.schedule_in(SchedulerEvent::TimerOverflow, this->cycles_until_overflow());
+}
 
-    if (this->memory_.consume_div_reset()) {
+// Same arithmetic as counting M-cycle by M-cycle, in one step.
+void Timer::tick(uint64_t m_cycles) {
+    if (this->div_reset_pending_) {
+        this->div_reset_pending_ = false;
         this->div_m_cycles_counter_ = 0;
     }
 
-    this->div_m_cycles_counter_ += static_cast<uint16_t>(m_cycles);
-    this->tima_m_cycles_counter_ += static_cast<uint16_t>(m_cycles);
+    if (this->stopped_) {
+        this->div_m_cycles_counter_ = static_cast<uint16_t>(this->div_m_cycles_counter_ + m_cycles);
+    } else { // 16384Hz
+        const uint64_t div_m_cycles = this->div_m_cycles_counter_ + m_cycles;
+        this->div_ = static_cast<uint8_t>(this->div_ + div_m_cycles / 64);
+        this->div_m_cycles_counter_ = static_cast<uint16_t>(div_m_cycles % 64);
+    }
 
-    while (this->div_m_cycles_counter_ >= 64 && !this->stopped_) { // 16384Hz
-        this->div_m_cycles_counter_ -= 64;
-        uint8_t div = this->get_div();
-        this->set_div(div + 1);
+    const bool tima_enabled = (this->tac_ & 0x04) != 0;
+    if (!tima_enabled) {
+        this->tima_m_cycles_counter_ = static_cast<uint16_t>(this->tima_m_cycles_counter_ + m_cycles);
+        return;
     }
 
-    uint8_t clock_select = this->get_tac() & 0x03;
-    bool tima_enabled = (this->get_tac() & 0x04) != 0;
-    if (!tima_enabled) return;
-
-    uint16_t increment = this->clock_select_increment_[clock_select];
-    while (this->tima_m_cycles_counter_ >= increment) {
-        this->tima_m_cycles_counter_ -= increment;
-
-        uint8_t tima = this->get_tima();
-        if (tima == 0xFF) {
-            this->set_tima(this->get_tma());
-            uint8_t IF = this->memory_.get_if();
-            this->memory_.set_if(static_cast<uint8_t>(IF | 0x04));
-        } else {
-            this->set_tima(static_cast<uint8_t>(tima + 1));
-        }
+    const uint64_t increment = this->clock_select_increment_[this->tac_ & 0x03];
+    const uint64_t tima_m_cycles = this->tima_m_cycles_counter_ + m_cycles;
+    this->tima_m_cycles_counter_ = static_cast<uint16_t>(tima_m_cycles % increment);
+    this->increment_tima(tima_m_cycles / increment);
+}
+
+void Timer::increment_tima(uint64_t increments) {
+    const uint64_t until_overflow = 0x100U - this->tima_;
+    if (increments < until_overflow) {
+        this->tima_ = static_cast<uint8_t>(this->tima_ + increments);
+        return;
     }
+
+    // Every overflow reloads TMA, so after the first one TIMA cycles through TMA..0xFF.
+    const uint64_t period = 0x100U - this->tma_;
+    this->tima_ = static_cast<uint8_t>(this->tma_ + (increments - until_overflow) % period);
+    this->memory_.set_if(static_cast<uint8_t>(this->memory_.get_if() | 0x04));
 }
 
-uint8_t Timer::get_div() { return this->memory_.read_byte(0xFF04); }
-void Timer::set_div(uint8_t value) { this->memory_.write_io_reg(0xFF04, value); }
+uint32_t Timer::cycles_until_overflow() const {
+    if ((this->tac_ & 0x04) == 0) return UINT32_MAX;
 
-uint8_t Timer::get_tima() { return this->memory_.read_byte(0xFF05); }
-void Timer::set_tima(uint8_t value) { this->memory_.write_byte(0xFF05, value); }
+    const uint32_t increment = this->clock_select_increment_[this->tac_ & 0x03];
+    const uint32_t increments_left = 0x100U - this->tima_;
+    const uint32_t m_cycles_left = increments_left * increment;
+    if (this->tima_m_cycles_counter_ >= m_cycles_left) return 0;
+    return (m_cycles_left - this->tima_m_cycles_counter_ - 1) * 4;
+}
 
-uint8_t Timer::get_tma() { return this->memory_.read_byte(0xFF06); }
-void Timer::set_tma(uint8_t value) { this->memory_.write_byte(0xFF06, value); }
+uint8_t Timer::read_register(uint16_t address) {
+    this->catch_up();
+    switch (address) {
+    case 0xFF04:
+        return this->div_;
+    case 0xFF05:
+        return this->tima_;
+    case 0xFF06:
+        return this->tma_;
+    default:
+        return this->tac_;
+    }
+}
 
-uint8_t Timer::get_tac() { return this->memory_.read_byte(0xFF07); }
-void Timer::set_tac(uint8_t value) { this->memory_.write_byte(0xFF07, value); }
+void Timer::write_register(uint16_t address, uint8_t value) {
+    this->catch_up();
+    switch (address) {
+    case 0xFF04: // Any write resets DIV, the internal counter follows once the instruction has finished
+        this->div_ = 0;
+        this->div_reset_pending_ = true;
+        break;
+    case 0xFF05:
+        this->tima_ = value;
+        break;
+    case 0xFF06:
+        this->tma_ = value;
+        break;
+    default:
+        this->tac_ = value;
+        break;
+    }
+    this->request_catch_up();
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+// Headless cartridge for the MBC tests: Memory, the scheduler and an Mbc wired up the way GB does it, with a
+// synthetic ROM whose every bank starts with its own bank number (low byte, then high byte).
+#include "mbc.hpp"
+#include "memory.hpp"
+#include "rom_image.hpp"
+#include "scheduler.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Cartridge {
+  public:
+    static constexpr size_t k_bank_size = 0x4000;
+
+    Cartridge(const std::string &name, uint8_t cartridge_type, size_t rom_banks, size_t ram_size) : mbc(memory, scheduler) {
+        std::vector<uint8_t> rom(rom_banks * k_bank_size, 0x00);
+        for (size_t bank = 0; bank < rom_banks; ++bank) {
+            rom[bank * k_bank_size] = static_cast<uint8_t>(bank & 0xFF);
+            rom[bank * k_bank_size + 1] = static_cast<uint8_t>(bank >> 8);
+        }
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / ("gbemu_" + name + ".gb");
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char *>(rom.data()), static_cast<std::streamsize>(rom.size()));
+        this->rom_image = std::make_unique<RomImage>(path.string());
+        std::filesystem::remove(path); // A mapping outlives the name, the heap fallback has already read it
+
+        this->memory.attach_mbc(&this->mbc);
+        this->memory.load_rom(*this->rom_image);
+        this->mbc.configure(cartridge_type, ram_size);
+    }
+
+    // Bank mapped at the window holding address (0x0000 or 0x4000), as read back through the page tables.
+    uint16_t bank_at(uint16_t window) {
+        return static_cast<uint16_t>(this->memory.read_byte(window) | (this->memory.read_byte(static_cast<uint16_t>(window + 1)) << 8));
+    }
+
+    void check(const std::string &what, unsigned got, unsigned expected) {
+        this->checked += 1;
+        if (got == expected) return;
+        this->failures += 1;
+        std::cerr << what << ": got 0x" << std::hex << std::uppercase << got << ", expected 0x" << expected << std::dec << '\n';
+    }
+
+    int report(const char *test) const {
+        std::cout << test << ": " << this->checked << " checks, " << this->failures << " failures\n";
+        return this->failures == 0 ? 0 : 1;
+    }
+
+    Memory memory;
+    Scheduler scheduler;
+    Mbc mbc;
+    std::unique_ptr<RomImage> rom_image;
+    uint64_t checked = 0;
+    uint64_t failures = 0;
+};
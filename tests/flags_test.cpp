@@ -0,0 +1,95 @@
+// Differential test of the lazy flags: every 8-bit ALU and INC/DEC input (operands x carry-in) is run once and the F
+// computed eagerly by ALU/IDU is compared with the F Registers materialises from the deferred operation. Built with
+// GBEMU_DEBUG, which is the configuration that keeps both paths.
+#include "alu.hpp"
+#include "idu.hpp"
+#include "memory.hpp"
+#include "registers.hpp"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+static_assert(config::k_lazy_flags && config::k_eager_flags, "flags_test needs both the lazy and the eager flags path");
+
+namespace {
+constexpr uint16_t k_scratch_address = 0xC000;
+
+struct Sweep {
+    Registers registers;
+    Memory memory;
+    ALU alu{registers};
+    IDU idu{registers, memory};
+    uint64_t checked = 0;
+    uint64_t failures = 0;
+
+    // Runs op with A and the carry flag preset and compares the two flags paths afterwards.
+    template <typename Op> void check(const char *name, uint8_t a, uint8_t operand, bool carry, Op op) {
+        this->registers.set_af(static_cast<uint16_t>((a << 8) | (carry ? FLAG_C_MASK : 0x00)));
+        this->checked += 1;
+        std::string mismatch;
+        try {
+            op();
+            const uint8_t eager = this->registers.F; // Written by the eager path, the deferred operation is still pending
+            const uint8_t lazy = static_cast<uint8_t>(this->registers.get_af() & 0xFF);
+            if (eager == lazy) return;
+            std::stringstream ss;
+            ss << "eager F 0x" << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(eager) << ", lazy F 0x" << std::setw(2)
+               << static_cast<int>(lazy);
+            mismatch = ss.str();
+        } catch (const std::runtime_error &error) {
+            mismatch = error.what(); // Registers' own Debug check caught it first
+        }
+
+        this->failures += 1;
+        if (this->failures > 20) return;
+        std::cerr << name << " A=0x" << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(a) << " operand=0x"
+                  << std::setw(2) << static_cast<int>(operand) << std::dec << " carry=" << carry << ": " << mismatch << '\n';
+    }
+};
+} // namespace
+
+int main() {
+    Sweep sweep;
+
+    for (int carry = 0; carry <= 1; ++carry) {
+        for (int a = 0; a <= 0xFF; ++a) {
+            const auto lhs = static_cast<uint8_t>(a);
+            for (int b = 0; b <= 0xFF; ++b) {
+                const auto rhs = static_cast<uint8_t>(b);
+                sweep.check("ADD", lhs, rhs, carry, [&] { sweep.alu.add_u8(rhs); });
+                sweep.check("ADC", lhs, rhs, carry, [&] { sweep.alu.adc_u8(rhs); });
+                sweep.check("SUB", lhs, rhs, carry, [&] { sweep.alu.sub_u8(rhs); });
+                sweep.check("SBC", lhs, rhs, carry, [&] { sweep.alu.sbc_u8(rhs); });
+                sweep.check("CP", lhs, rhs, carry, [&] { sweep.alu.cp_u8(rhs); });
+                sweep.check("AND", lhs, rhs, carry, [&] { sweep.alu.and_u8(rhs); });
+                sweep.check("OR", lhs, rhs, carry, [&] { sweep.alu.or_u8(rhs); });
+                sweep.check("XOR", lhs, rhs, carry, [&] { sweep.alu.xor_u8(rhs); });
+            }
+
+            // INC/DEC keep C, so the carry-in is what they have to preserve.
+            sweep.check("INC r", 0x00, lhs, carry, [&] {
+                uint8_t value = lhs;
+                sweep.idu.increment_r8(value);
+            });
+            sweep.check("DEC r", 0x00, lhs, carry, [&] {
+                uint8_t value = lhs;
+                sweep.idu.decrement_r8(value);
+            });
+            sweep.check("INC (HL)", 0x00, lhs, carry, [&] {
+                sweep.memory.write_byte(k_scratch_address, lhs);
+                sweep.idu.increment_mem8(k_scratch_address);
+            });
+            sweep.check("DEC (HL)", 0x00, lhs, carry, [&] {
+                sweep.memory.write_byte(k_scratch_address, lhs);
+                sweep.idu.decrement_mem8(k_scratch_address);
+            });
+        }
+    }
+
+    std::cout << sweep.checked << " inputs checked, " << sweep.failures << " mismatches\n";
+    return sweep.failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+// MBC1 and MBC2 bank switching and cartridge RAM, driven through Memory's reads and writes like a game would.
+#include "cartridge.hpp"
+
+#include <cstdint>
+
+namespace {
+// 1 MB ROM (64 banks) and 32 KB RAM (4 banks).
+int test_mbc1() {
+    Cartridge cart("mbc1", 0x03, 64, 0x8000);
+    cart.check("power-on 0x0000 bank", cart.bank_at(0x0000), 0x00);
+    cart.check("power-on 0x4000 bank", cart.bank_at(0x4000), 0x01);
+
+    cart.memory.write_byte(0x2000, 0x05);
+    cart.check("bank 5", cart.bank_at(0x4000), 0x05);
+    cart.memory.write_byte(0x2000, 0x00);
+    cart.check("bank 0x00 reads as 0x01", cart.bank_at(0x4000), 0x01);
+    cart.memory.write_byte(0x3FFF, 0x1F);
+    cart.check("bank 0x1F", cart.bank_at(0x4000), 0x1F);
+    cart.memory.write_byte(0x2000, 0x20); // Only 5 bits are stored, so this is bank 0 again
+    cart.check("bank1 is 5 bits wide", cart.bank_at(0x4000), 0x01);
+
+    cart.memory.write_byte(0x4000, 0x01);
+    cart.check("bank 0x20 reads as 0x21", cart.bank_at(0x4000), 0x21);
+    cart.check("mode 0 keeps bank 0 at 0x0000", cart.bank_at(0x0000), 0x00);
+    cart.memory.write_byte(0x2000, 0x02);
+    cart.check("bank 0x22", cart.bank_at(0x4000), 0x22);
+
+    // Mode 1: the upper bits also select the 0x0000 window and the RAM bank.
+    cart.memory.write_byte(0x6000, 0x01);
+    cart.check("mode 1 0x0000 bank", cart.bank_at(0x0000), 0x20);
+    cart.check("mode 1 0x4000 bank", cart.bank_at(0x4000), 0x22);
+    cart.memory.write_byte(0x4000, 0x03); // Bank 0x62 on a 64-bank ROM wraps to 0x22
+    cart.check("mode 1 0x0000 bank wraps", cart.bank_at(0x0000), 0x20);
+    cart.check("mode 1 0x4000 bank wraps", cart.bank_at(0x4000), 0x22);
+
+    // RAM is disabled at power-on and enabled by 0x0A in the low nibble.
+    cart.check("disabled RAM reads 0xFF", cart.memory.read_byte(0xA000), 0xFF);
+    cart.memory.write_byte(0xA000, 0x12);
+    cart.memory.write_byte(0x0000, 0x1A);
+    cart.check("writes to disabled RAM are dropped", cart.memory.read_byte(0xA000), 0x00);
+    for (uint8_t bank = 0; bank < 4; ++bank) {
+        cart.memory.write_byte(0x4000, bank);
+        cart.memory.write_byte(0xA000, static_cast<uint8_t>(0x10 + bank));
+        cart.memory.write_byte(0xBFFF, static_cast<uint8_t>(0x20 + bank));
+    }
+    for (uint8_t bank = 0; bank < 4; ++bank) {
+        cart.memory.write_byte(0x4000, bank);
+        cart.check("mode 1 RAM bank start", cart.memory.read_byte(0xA000), 0x10u + bank);
+        cart.check("mode 1 RAM bank end", cart.memory.read_byte(0xBFFF), 0x20u + bank);
+    }
+    cart.memory.write_byte(0x6000, 0x00);
+    cart.check("mode 0 RAM is bank 0", cart.memory.read_byte(0xA000), 0x10);
+    cart.check("mode 0 0x4000 bank", cart.bank_at(0x4000), 0x62 % 64);
+    cart.memory.write_byte(0x0000, 0x00);
+    cart.check("RAM disabled again", cart.memory.read_byte(0xA000), 0xFF);
+    return cart.report("mbc1");
+}
+
+// 2 KB of RAM is mirrored across the 8 KB window.
+int test_mbc1_small_ram() {
+    Cartridge cart("mbc1_small_ram", 0x03, 4, 0x0800);
+    cart.memory.write_byte(0x0000, 0x0A);
+    cart.memory.write_byte(0xA000, 0x5A);
+    cart.memory.write_byte(0xA7FF, 0xA5);
+    cart.check("mirror at 0xA800", cart.memory.read_byte(0xA800), 0x5A);
+    cart.check("mirror at 0xB000", cart.memory.read_byte(0xB000), 0x5A);
+    cart.check("mirror at 0xBFFF", cart.memory.read_byte(0xBFFF), 0xA5);
+    cart.memory.write_byte(0xB801, 0x3C);
+    cart.check("write through a mirror", cart.memory.read_byte(0xA001), 0x3C);
+    return cart.report("mbc1 small RAM");
+}
+
+// 256 KB ROM (16 banks) and the built-in 512 x 4-bit RAM.
+int test_mbc2() {
+    Cartridge cart("mbc2", 0x06, 16, 0);
+
+    // Address bit 8 set selects the ROM bank register, clear the RAM enable.
+    cart.memory.write_byte(0x2100, 0x00);
+    cart.check("bank 0x00 reads as 0x01", cart.bank_at(0x4000), 0x01);
+    cart.memory.write_byte(0x2100, 0x0F);
+    cart.check("bank 0x0F", cart.bank_at(0x4000), 0x0F);
+    cart.memory.write_byte(0x2100, 0x13);
+    cart.check("bank is 4 bits wide", cart.bank_at(0x4000), 0x03);
+    cart.memory.write_byte(0x0100, 0x05);
+    cart.check("bit 8 selects the bank below 0x2000 too", cart.bank_at(0x4000), 0x05);
+    cart.memory.write_byte(0x2000, 0x07);
+    cart.check("bit 8 clear does not select a bank", cart.bank_at(0x4000), 0x05);
+    cart.memory.write_byte(0x4100, 0x02);
+    cart.check("no registers at 0x4000-0x7FFF", cart.bank_at(0x4000), 0x05);
+
+    cart.check("disabled RAM reads 0xFF", cart.memory.read_byte(0xA000), 0xFF);
+    cart.memory.write_byte(0x0100, 0x0A);
+    cart.check("bit 8 set does not enable RAM", cart.memory.read_byte(0xA000), 0xFF);
+    cart.memory.write_byte(0x0000, 0x0A);
+    cart.memory.write_byte(0xA000, 0x5C);
+    cart.check("upper nibble is open bus", cart.memory.read_byte(0xA000), 0xFC);
+    cart.check("512 bytes mirrored", cart.memory.read_byte(0xA200), 0xFC);
+    cart.memory.write_byte(0xA1FF, 0x03);
+    cart.check("mirrored to the end of the window", cart.memory.read_byte(0xBFFF), 0xF3);
+    cart.memory.write_byte(0x0000, 0x00);
+    cart.check("RAM disabled again", cart.memory.read_byte(0xA000), 0xFF);
+    return cart.report("mbc2");
+}
+} // namespace
+
+int main() {
+    int result = 0;
+    result |= test_mbc1();
+    result |= test_mbc1_small_ram();
+    result |= test_mbc2();
+    return result;
+}
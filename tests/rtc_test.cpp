@@ -0,0 +1,207 @@
+// MBC3 real-time clock: the lazily synced seconds count, halting, the day carry and the .sav footer. Emulated time is
+// advanced directly on the scheduler.
+#include "cartridge.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+namespace {
+constexpr uint8_t k_seconds = 0x08;
+constexpr uint8_t k_hours = 0x0A;
+constexpr uint8_t k_day_high = 0x0C;
+constexpr size_t k_ram_size = 0x2000;
+
+using Clock = std::array<uint8_t, 5>; // Seconds, minutes, hours, day low, day high
+
+// MBC3+TIMER+RAM+BATTERY with its RAM and clock registers enabled.
+struct RtcCartridge : Cartridge {
+    explicit RtcCartridge(const std::string &name) : Cartridge(name, 0x10, 4, k_ram_size) { this->memory.write_byte(0x0000, 0x0A); }
+
+    void advance(uint64_t cycles) {
+        while (cycles > 0) {
+            const auto step = static_cast<uint32_t>(std::min<uint64_t>(cycles, config::k_cpu_clock_hz));
+            this->scheduler.advance(step);
+            cycles -= step;
+        }
+    }
+    void advance_seconds(uint64_t seconds) { this->advance(seconds * config::k_cpu_clock_hz); }
+    // Fractions of a second in 1/100ths.
+    void advance_centiseconds(uint64_t centiseconds) { this->advance(centiseconds * config::k_cpu_clock_hz / 100); }
+
+    void write(uint8_t select, uint8_t value) {
+        this->memory.write_byte(0x4000, select);
+        this->memory.write_byte(0xA000, value);
+    }
+    void set(const Clock &clock) {
+        this->write(k_day_high, static_cast<uint8_t>(clock[4] | 0x40)); // Halted while it is being set
+        for (uint8_t i = 0; i < 4; ++i) this->write(static_cast<uint8_t>(k_seconds + i), clock[i]);
+        this->write(k_day_high, clock[4]);
+    }
+    void latch() {
+        this->memory.write_byte(0x6000, 0x00);
+        this->memory.write_byte(0x6000, 0x01);
+    }
+    Clock latched() {
+        Clock clock{};
+        for (uint8_t i = 0; i < 5; ++i) {
+            this->memory.write_byte(0x4000, static_cast<uint8_t>(k_seconds + i));
+            clock[i] = this->memory.read_byte(0xA000);
+        }
+        return clock;
+    }
+    void check_clock(const std::string &what, const Clock &expected) {
+        const Clock clock = this->latched();
+        static constexpr std::array<const char *, 5> k_names = {" S", " M", " H", " DL", " DH"};
+        for (size_t i = 0; i < clock.size(); ++i) this->check(what + k_names[i], clock[i], expected[i]);
+    }
+};
+
+int test_counting() {
+    RtcCartridge cart("rtc_counting");
+    cart.set({0, 0, 0, 0, 0});
+    cart.advance_seconds(5);
+    cart.check_clock("not latched yet", {0, 0, 0, 0, 0});
+    cart.latch();
+    cart.check_clock("after 5 s", {5, 0, 0, 0, 0});
+
+    cart.advance_seconds(86400 + 3600 + 60 + 1 - 5);
+    cart.check_clock("latch holds", {5, 0, 0, 0, 0});
+    cart.memory.write_byte(0x6000, 0x01); // Only 0x00 then 0x01 latches
+    cart.check_clock("0x01 alone does not latch", {5, 0, 0, 0, 0});
+    cart.latch();
+    cart.check_clock("after 1d 1h 1m 1s", {1, 1, 1, 1, 0});
+
+    cart.advance_seconds(255 * 86400);
+    cart.latch();
+    cart.check_clock("day 256 sets day bit 8", {1, 1, 1, 0, 0x01});
+
+    // Registers written out of range are folded into the count as they are written.
+    cart.set({0, 0, 0, 0, 0});
+    cart.write(k_seconds, 63);
+    cart.latch();
+    cart.check_clock("63 seconds fold into the minutes", {3, 1, 0, 0, 0});
+    cart.write(k_hours, 31); // 5 bits, so 31 hours is a day and 7 hours
+    cart.latch();
+    cart.check_clock("31 hours fold into the days", {3, 1, 7, 1, 0});
+    return cart.report("rtc counting");
+}
+
+int test_halt_and_seconds_write() {
+    RtcCartridge cart("rtc_halt");
+    cart.set({0, 0, 0, 0, 0}); // Writing the seconds starts a new second
+
+    cart.advance_centiseconds(75);
+    cart.write(k_day_high, 0x40);
+    cart.advance_seconds(10);
+    cart.latch();
+    cart.check_clock("halted clock stands still", {0, 0, 0, 0, 0x40});
+
+    cart.write(k_day_high, 0x00);
+    cart.advance_centiseconds(50);
+    cart.latch();
+    cart.check_clock("0.75 s before and 0.5 s after the halt", {1, 0, 0, 0, 0});
+    cart.advance_centiseconds(70);
+    cart.latch();
+    cart.check_clock("1.95 s", {1, 0, 0, 0, 0});
+    cart.advance_centiseconds(10);
+    cart.latch();
+    cart.check_clock("2.05 s", {2, 0, 0, 0, 0});
+
+    cart.advance_centiseconds(90);
+    cart.write(k_seconds, 10);
+    cart.advance_centiseconds(50);
+    cart.latch();
+    cart.check_clock("seconds write drops the second in progress", {10, 0, 0, 0, 0});
+    cart.advance_centiseconds(60);
+    cart.latch();
+    cart.check_clock("a full second after the write", {11, 0, 0, 0, 0});
+    return cart.report("rtc halt");
+}
+
+int test_day_carry() {
+    RtcCartridge cart("rtc_carry");
+    cart.set({58, 59, 23, 0xFF, 0x01}); // Day 511, two seconds before it overflows
+    cart.advance_seconds(1);
+    cart.latch();
+    cart.check_clock("last second of day 511", {59, 59, 23, 0xFF, 0x01});
+    cart.advance_seconds(1);
+    cart.latch();
+    cart.check_clock("512 days set the carry", {0, 0, 0, 0, 0x80});
+    cart.advance_seconds(86400);
+    cart.latch();
+    cart.check_clock("carry is sticky", {0, 0, 0, 1, 0x80});
+    cart.write(k_day_high, 0x00);
+    cart.latch();
+    cart.check_clock("writing day high clears it", {0, 0, 0, 1, 0x00});
+    return cart.report("rtc carry");
+}
+
+uint64_t unix_now() {
+    const auto since_epoch = std::chrono::system_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(since_epoch).count());
+}
+
+// RAM, then the live and latched registers as little-endian 32-bit values and the save time in 8 or 4 bytes.
+std::string battery_file(const Clock &live, const Clock &latched, uint64_t saved_at, size_t time_bytes) {
+    std::string data(k_ram_size, '\0');
+    data[0] = 0x42;
+    for (const Clock *clock : {&live, &latched}) {
+        for (const uint8_t value : *clock) data += std::string{static_cast<char>(value), '\0', '\0', '\0'};
+    }
+    for (size_t i = 0; i < time_bytes; ++i) data += static_cast<char>((saved_at >> (8 * i)) & 0xFF);
+    return data;
+}
+
+int test_battery() {
+    RtcCartridge saved("rtc_save");
+    saved.memory.write_byte(0x4000, 0x00);
+    saved.memory.write_byte(0xA123, 0x99);
+    saved.set({12, 34, 5, 0x67, 0x41}); // Halted, so host time passing does not move it
+    saved.latch();
+    saved.set({1, 2, 3, 0x04, 0xC1}); // Latched and live registers differ
+    std::stringstream file;
+    saved.mbc.save_battery(file);
+    saved.check("footer size", static_cast<unsigned>(file.str().size()), static_cast<unsigned>(k_ram_size + 48));
+
+    RtcCartridge loaded("rtc_load");
+    loaded.mbc.load_battery(file);
+    loaded.check_clock("latched registers restored", {12, 34, 5, 0x67, 0x41});
+    loaded.latch();
+    loaded.check_clock("live registers restored", {1, 2, 3, 0x04, 0xC1});
+    loaded.memory.write_byte(0x4000, 0x00);
+    loaded.check("RAM restored", loaded.memory.read_byte(0xA123), 0x99);
+
+    // A running clock makes up for the host time since it was saved.
+    std::stringstream running(battery_file({0, 0, 0, 0, 0}, {0, 0, 0, 0, 0}, unix_now() - 100, 8));
+    RtcCartridge caught_up("rtc_catch_up");
+    caught_up.mbc.load_battery(running);
+    caught_up.latch();
+    const Clock clock = caught_up.latched();
+    caught_up.check("100 s of host time made up", clock[0] >= 40 && clock[0] <= 42 && clock[1] == 1, 1);
+
+    // The 44-byte footer with a 32-bit time.
+    std::stringstream short_footer(battery_file({7, 8, 9, 10, 0x40}, {1, 2, 3, 4, 0}, unix_now() - 100, 4));
+    RtcCartridge short_loaded("rtc_short_footer");
+    short_loaded.mbc.load_battery(short_footer);
+    short_loaded.check_clock("44-byte footer latched registers", {1, 2, 3, 4, 0});
+    short_loaded.latch();
+    short_loaded.check_clock("44-byte footer live registers", {7, 8, 9, 10, 0x40});
+    short_loaded.memory.write_byte(0x4000, 0x00);
+    short_loaded.check("44-byte footer RAM", short_loaded.memory.read_byte(0xA000), 0x42);
+    return saved.report("rtc save") | loaded.report("rtc load") | caught_up.report("rtc catch-up") |
+           short_loaded.report("rtc 44-byte footer");
+}
+} // namespace
+
+int main() {
+    int result = 0;
+    result |= test_counting();
+    result |= test_halt_and_seconds_write();
+    result |= test_day_carry();
+    result |= test_battery();
+    return result;
+}
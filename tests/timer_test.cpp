@@ -0,0 +1,100 @@
+// Timer::tick advances DIV and TIMA over a whole span in closed form. This checks it against ticking one M-cycle at a
+// time, from random DIV/TIMA/TMA/TAC/counter states (including ones with STOP, TIMA disabled and a DIV reset pending)
+// over spans long enough for several TMA reloads and for the 16-bit internal counters to wrap.
+#include "memory.hpp"
+#include "registers.hpp"
+#include "scheduler.hpp"
+#include "timer.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+
+namespace {
+constexpr uint32_t k_trials = 4000;
+
+// A Timer with everything it is wired to.
+struct Machine {
+    Registers registers;
+    Memory memory;
+    Scheduler scheduler;
+    bool stopped = false;
+    Timer timer{registers, memory, scheduler, stopped};
+
+    void start(Timer::State state, bool stop) {
+        state.synced_cycle = this->scheduler.now();
+        state.catch_up_requested = false;
+        this->timer.load_state(state);
+        this->stopped = stop;
+        this->memory.set_if(0x00);
+    }
+    Timer::State finish() const {
+        Timer::State state{};
+        this->timer.save_state(state);
+        return state;
+    }
+};
+
+bool same(const Timer::State &a, const Timer::State &b) {
+    return a.div == b.div && a.tima == b.tima && a.tma == b.tma && a.tac == b.tac && a.div_reset_pending == b.div_reset_pending &&
+           a.div_m_cycles_counter == b.div_m_cycles_counter && a.tima_m_cycles_counter == b.tima_m_cycles_counter;
+}
+
+void print(const char *label, const Timer::State &state, uint8_t interrupt_flag) {
+    std::cerr << "  " << label << ": DIV " << static_cast<int>(state.div) << " TIMA " << static_cast<int>(state.tima) << " TMA "
+              << static_cast<int>(state.tma) << " TAC " << static_cast<int>(state.tac) << " DIV counter " << state.div_m_cycles_counter
+              << " TIMA counter " << state.tima_m_cycles_counter << " DIV reset pending " << state.div_reset_pending << " IF "
+              << static_cast<int>(interrupt_flag) << '\n';
+}
+} // namespace
+
+int main() {
+    std::mt19937 rng(0x6B656D);
+    auto random = [&rng](uint32_t low, uint32_t high) { return std::uniform_int_distribution<uint32_t>(low, high)(rng); };
+
+    Machine bulk;
+    Machine stepped;
+    uint32_t failures = 0;
+    uint64_t m_cycles_checked = 0;
+    for (uint32_t trial = 0; trial < k_trials; ++trial) {
+        const Timer::State start = {.div = static_cast<uint8_t>(random(0, 0xFF)),
+                                    .tima = static_cast<uint8_t>(random(0, 0xFF)),
+                                    .tma = static_cast<uint8_t>(random(0, 0xFF)),
+                                    .tac = static_cast<uint8_t>(random(0, 0xFF)),
+                                    .synced_cycle = 0,
+                                    .catch_up_requested = false,
+                                    .div_reset_pending = random(0, 3) == 0,
+                                    .div_m_cycles_counter = static_cast<uint16_t>(random(0, 1) == 0 ? random(0, 63) : random(0, 0xFFFF)),
+                                    .tima_m_cycles_counter = static_cast<uint16_t>(random(0, 1) == 0 ? random(0, 255) : random(0, 0xFFFF))};
+        const bool stop = random(0, 7) == 0;
+        const uint32_t bucket = random(0, 9);
+        const uint32_t m_cycles = bucket < 6 ? random(1, 1024) : bucket < 9 ? random(1, 20000) : random(0xFF00, 0x20000);
+
+        bulk.start(start, stop);
+        bulk.scheduler.advance(m_cycles * 4);
+        bulk.timer.catch_up();
+
+        stepped.start(start, stop);
+        for (uint32_t i = 0; i < m_cycles; ++i) {
+            stepped.scheduler.advance(4);
+            stepped.timer.catch_up();
+        }
+        m_cycles_checked += m_cycles;
+
+        const Timer::State bulk_end = bulk.finish();
+        const Timer::State stepped_end = stepped.finish();
+        const uint8_t bulk_if = bulk.memory.get_if();
+        const uint8_t stepped_if = stepped.memory.get_if();
+        if (same(bulk_end, stepped_end) && bulk_if == stepped_if) continue;
+
+        failures += 1;
+        if (failures > 10) continue;
+        std::cerr << "Trial " << trial << ", " << m_cycles << " M-cycles" << (stop ? ", stopped" : "") << ":\n";
+        print("start", start, 0x00);
+        print("tick(n)", bulk_end, bulk_if);
+        print("n x tick(1)", stepped_end, stepped_if);
+    }
+
+    std::cout << k_trials << " spans (" << m_cycles_checked << " M-cycles) checked, " << failures << " mismatches\n";
+    return failures == 0 ? 0 : 1;
+}